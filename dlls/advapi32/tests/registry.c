@@ -2334,6 +2334,74 @@ static void test_rw_order(void)
     ok(!RegDeleteKeyA(HKEY_CURRENT_USER, keyname), "Failed to delete key\n");
 }
 
+static void test_subkey_order(void)
+{
+    static const char keyname[] = "test_subkey_order";
+    char name[16], expect[16];
+    HKEY hkey, subkey;
+    DWORD count, len;
+    LSTATUS ret;
+    int i;
+
+    ret = RegCreateKeyA(hkey_main, keyname, &hkey);
+    ok(!ret, "RegCreateKeyA failed: %d\n", ret);
+
+    /* create the subkeys out of order, mixing the case */
+    for (i = 0; i < 300; i++)
+    {
+        sprintf(name, (i & 1) ? "Key%03u" : "kEY%03u", (i * 7) % 300);
+        ret = RegCreateKeyA(hkey, name, &subkey);
+        ok(!ret, "RegCreateKeyA %s failed: %d\n", name, ret);
+        RegCloseKey(subkey);
+    }
+
+    ret = RegQueryInfoKeyA(hkey, NULL, NULL, NULL, &count, NULL, NULL, NULL, NULL, NULL, NULL, NULL);
+    ok(!ret, "RegQueryInfoKeyA failed: %d\n", ret);
+    ok(count == 300, "Expected 300 subkeys, got %u\n", count);
+
+    /* subkeys are enumerated in alphabetical order */
+    for (i = 0; i < 300; i++)
+    {
+        len = sizeof(name);
+        ret = RegEnumKeyExA(hkey, i, name, &len, NULL, NULL, NULL, NULL);
+        ok(!ret, "RegEnumKeyExA %d failed: %d\n", i, ret);
+        sprintf(expect, "key%03u", i);
+        ok(!lstrcmpiA(name, expect), "%d: expected %s, got %s\n", i, expect, name);
+    }
+    len = sizeof(name);
+    ret = RegEnumKeyExA(hkey, 300, name, &len, NULL, NULL, NULL, NULL);
+    ok(ret == ERROR_NO_MORE_ITEMS, "expected ERROR_NO_MORE_ITEMS, got %d\n", ret);
+
+    /* random access and backwards enumeration */
+    for (i = 299; i >= 0; i -= 13)
+    {
+        len = sizeof(name);
+        ret = RegEnumKeyExA(hkey, i, name, &len, NULL, NULL, NULL, NULL);
+        ok(!ret, "RegEnumKeyExA %d failed: %d\n", i, ret);
+        sprintf(expect, "key%03u", i);
+        ok(!lstrcmpiA(name, expect), "%d: expected %s, got %s\n", i, expect, name);
+    }
+
+    /* enumeration stays consistent after deleting subkeys */
+    for (i = 0; i < 300; i += 2)
+    {
+        sprintf(name, "key%03u", i);
+        ret = RegDeleteKeyA(hkey, name);
+        ok(!ret, "RegDeleteKeyA %s failed: %d\n", name, ret);
+    }
+    for (i = 0; i < 150; i++)
+    {
+        len = sizeof(name);
+        ret = RegEnumKeyExA(hkey, i, name, &len, NULL, NULL, NULL, NULL);
+        ok(!ret, "RegEnumKeyExA %d failed: %d\n", i, ret);
+        sprintf(expect, "key%03u", 2 * i + 1);
+        ok(!lstrcmpiA(name, expect), "%d: expected %s, got %s\n", i, expect, name);
+    }
+
+    delete_key(hkey);
+    RegCloseKey(hkey);
+}
+
 static void test_symlinks(void)
 {
     static const WCHAR targetW[] = {'\\','S','o','f','t','w','a','r','e','\\','W','i','n','e',
@@ -3498,6 +3566,7 @@ START_TEST(registry)
     test_reg_query_value();
     test_reg_query_info();
     test_string_termination();
+    test_subkey_order();
     test_symlinks();
     test_redirection();
     test_classesroot();
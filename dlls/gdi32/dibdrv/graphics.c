@@ -20,6 +20,7 @@
 
 #include <assert.h>
 #include "gdi_private.h"
+#include "winreg.h"
 #include "dibdrv.h"
 
 #include "wine/unicode.h"
@@ -43,10 +44,17 @@ enum glyph_type
 #define GLYPH_CACHE_PAGE_SIZE  0x100
 #define GLYPH_CACHE_PAGES      (0x10000 / GLYPH_CACHE_PAGE_SIZE)
 
+#define FONT_CACHE_BUCKETS     64
+#define FONT_CACHE_MIN_UNUSED  5      /* unused fonts that are always kept around */
+#define FONT_CACHE_MAX_UNUSED  64     /* unused fonts that are kept within the glyph budget */
+#define GLYPH_CACHE_DEFAULT_KB 4096   /* default glyph budget, see get_glyph_cache_max */
+
 struct cached_font
 {
-    struct list           entry;
+    struct list           entry;       /* entry in the LRU list */
+    struct list           hash_entry;  /* entry in the hash bucket */
     LONG                  ref;
+    LONG                  glyph_size;  /* size of the cached glyph bitmaps */
     DWORD                 hash;
     LOGFONTW              lf;
     XFORM                 xform;
@@ -55,6 +63,10 @@ struct cached_font
 };
 
 static struct list font_cache = LIST_INIT( font_cache );
+static struct list font_cache_buckets[FONT_CACHE_BUCKETS];
+static LONG glyph_cache_size;
+static LONG glyph_cache_max;
+static INIT_ONCE font_cache_init_once = INIT_ONCE_STATIC_INIT;
 
 static CRITICAL_SECTION font_cache_cs;
 static CRITICAL_SECTION_DEBUG critsect_debug =
@@ -552,10 +564,81 @@ static int font_cache_cmp( const struct cached_font *p1, const struct cached_fon
     return ret;
 }
 
+/* maximum size of the glyphs of unused fonts, configurable through the
+ * GlyphCacheSize value (in kilobytes) of HKCU\Software\Wine\Fonts;
+ * 0 keeps only the FONT_CACHE_MIN_UNUSED most recently used fonts */
+static LONG get_glyph_cache_max(void)
+{
+    HKEY hkey;
+    DWORD type, size, value = GLYPH_CACHE_DEFAULT_KB;
+
+    if (!RegOpenKeyA( HKEY_CURRENT_USER, "Software\\Wine\\Fonts", &hkey ))
+    {
+        size = sizeof(value);
+        if (RegQueryValueExA( hkey, "GlyphCacheSize", NULL, &type, (BYTE *)&value, &size ) ||
+            type != REG_DWORD)
+            value = GLYPH_CACHE_DEFAULT_KB;
+        RegCloseKey( hkey );
+    }
+    value = min( value, 0x10000 );  /* 64Mb */
+    TRACE( "using %u Kb for the glyph cache\n", value );
+    return value * 1024;
+}
+
+static BOOL WINAPI init_font_cache( INIT_ONCE *once, void *param, void **context )
+{
+    UINT i;
+
+    for (i = 0; i < FONT_CACHE_BUCKETS; i++) list_init( &font_cache_buckets[i] );
+    glyph_cache_max = get_glyph_cache_max();
+    return TRUE;
+}
+
+static void free_cached_font( struct cached_font *font )
+{
+    UINT i, j, k;
+
+    for (i = 0; i < GLYPH_NBTYPES; i++)
+    {
+        for (j = 0; j < GLYPH_CACHE_PAGES; j++)
+        {
+            if (!font->glyphs[i][j]) continue;
+            for (k = 0; k < GLYPH_CACHE_PAGE_SIZE; k++)
+                HeapFree( GetProcessHeap(), 0, font->glyphs[i][j][k] );
+            HeapFree( GetProcessHeap(), 0, font->glyphs[i][j] );
+        }
+    }
+    InterlockedExchangeAdd( &glyph_cache_size, -font->glyph_size );
+    list_remove( &font->entry );
+    list_remove( &font->hash_entry );
+    HeapFree( GetProcessHeap(), 0, font );
+}
+
+/* free the least recently used fonts that are no longer needed, keeping a few of
+ * them and as many more as fit in the glyph budget; font_cache_cs must be held */
+static void trim_font_cache(void)
+{
+    struct cached_font *ptr, *next;
+    UINT unused = 0;
+
+    LIST_FOR_EACH_ENTRY( ptr, &font_cache, struct cached_font, entry )
+        if (!ptr->ref) unused++;
+
+    LIST_FOR_EACH_ENTRY_SAFE_REV( ptr, next, &font_cache, struct cached_font, entry )
+    {
+        if (unused <= FONT_CACHE_MIN_UNUSED) break;
+        if (unused <= FONT_CACHE_MAX_UNUSED && glyph_cache_max && glyph_cache_size <= glyph_cache_max) break;
+        if (ptr->ref) continue;
+        TRACE( "freeing %p, %d bytes of glyphs\n", ptr, ptr->glyph_size );
+        free_cached_font( ptr );
+        unused--;
+    }
+}
+
 static struct cached_font *add_cached_font( DC *dc, HFONT hfont, UINT aa_flags )
 {
-    struct cached_font font, *ptr, *last_unused = NULL;
-    UINT i = 0, j, k;
+    struct cached_font font, *ptr;
+    struct list *bucket;
 
     GetObjectW( hfont, sizeof(font.lf), &font.lf );
     font.xform = dc->xformWorld2Vport;
@@ -570,8 +653,12 @@ static struct cached_font *add_cached_font( DC *dc, HFONT hfont, UINT aa_flags )
     font.aa_flags = aa_flags;
     font.hash = font_cache_hash( &font );
 
+    InitOnceExecuteOnce( &font_cache_init_once, init_font_cache, NULL, NULL );
+
     EnterCriticalSection( &font_cache_cs );
-    LIST_FOR_EACH_ENTRY( ptr, &font_cache, struct cached_font, entry )
+    bucket = &font_cache_buckets[font.hash % FONT_CACHE_BUCKETS];
+
+    LIST_FOR_EACH_ENTRY( ptr, bucket, struct cached_font, hash_entry )
     {
         if (!font_cache_cmp( &font, ptr ))
         {
@@ -579,29 +666,11 @@ static struct cached_font *add_cached_font( DC *dc, HFONT hfont, UINT aa_flags )
             list_remove( &ptr->entry );
             goto done;
         }
-        if (!ptr->ref)
-        {
-            i++;
-            last_unused = ptr;
-        }
     }
 
-    if (i > 5)  /* keep at least 5 of the most-recently used fonts around */
-    {
-        ptr = last_unused;
-        for (i = 0; i < GLYPH_NBTYPES; i++)
-        {
-            for (j = 0; j < GLYPH_CACHE_PAGES; j++)
-            {
-                if (!ptr->glyphs[i][j]) continue;
-                for (k = 0; k < GLYPH_CACHE_PAGE_SIZE; k++)
-                    HeapFree( GetProcessHeap(), 0, ptr->glyphs[i][j][k] );
-                HeapFree( GetProcessHeap(), 0, ptr->glyphs[i][j] );
-            }
-        }
-        list_remove( &ptr->entry );
-    }
-    else if (!(ptr = HeapAlloc( GetProcessHeap(), 0, sizeof(*ptr) )))
+    trim_font_cache();
+
+    if (!(ptr = HeapAlloc( GetProcessHeap(), 0, sizeof(*ptr) )))
     {
         LeaveCriticalSection( &font_cache_cs );
         return NULL;
@@ -609,7 +678,9 @@ static struct cached_font *add_cached_font( DC *dc, HFONT hfont, UINT aa_flags )
 
     *ptr = font;
     ptr->ref = 1;
+    ptr->glyph_size = 0;
     memset( ptr->glyphs, 0, sizeof(ptr->glyphs) );
+    list_add_head( bucket, &ptr->hash_entry );
 done:
     list_add_head( &font_cache, &ptr->entry );
     LeaveCriticalSection( &font_cache_cs );
@@ -623,7 +694,7 @@ void release_cached_font( struct cached_font *font )
 }
 
 static struct cached_glyph *add_cached_glyph( struct cached_font *font, UINT index, UINT flags,
-                                              struct cached_glyph *glyph )
+                                              struct cached_glyph *glyph, UINT size )
 {
     struct cached_glyph *ret;
     enum glyph_type type = (flags & ETO_GLYPH_INDEX) ? GLYPH_INDEX : GLYPH_WCHAR;
@@ -644,7 +715,12 @@ static struct cached_glyph *add_cached_glyph( struct cached_font *font, UINT ind
             HeapFree( GetProcessHeap(), 0, ptr );
     }
     ret = InterlockedCompareExchangePointer( (void **)&font->glyphs[type][page][entry], glyph, NULL );
-    if (!ret) ret = glyph;
+    if (!ret)
+    {
+        InterlockedExchangeAdd( &font->glyph_size, size );
+        InterlockedExchangeAdd( &glyph_cache_size, size );
+        ret = glyph;
+    }
     else HeapFree( GetProcessHeap(), 0, glyph );
     return ret;
 }
@@ -803,7 +879,7 @@ static struct cached_glyph *cache_glyph_bitmap( DC *dc, struct cached_font *font
 
 done:
     glyph->metrics = metrics;
-    return add_cached_glyph( font, index, flags, glyph );
+    return add_cached_glyph( font, index, flags, glyph, FIELD_OFFSET( struct cached_glyph, bits[size] ));
 }
 
 static void render_string( DC *dc, dib_info *dib, struct cached_font *font, INT x, INT y,
@@ -25,8 +25,35 @@
 
 #include "wine/debug.h"
 
+/* SSE2 is always available on x86-64; on i386 it is checked for at run time,
+ * which needs per-function target attributes. */
+#if defined(__x86_64__) || (defined(__i386__) && defined(__GNUC__) && \
+    (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 9)))
+#define HAVE_DIB_SSE2
+#include <emmintrin.h>
+#ifdef __i386__
+#define SSE2_TARGET __attribute__((target("sse2")))
+#else
+#define SSE2_TARGET
+#endif
+#endif
+
 WINE_DEFAULT_DEBUG_CHANNEL(dib);
 
+#ifdef HAVE_DIB_SSE2
+static inline BOOL sse2_supported(void)
+{
+#ifdef __x86_64__
+    return TRUE;
+#else
+    static int supported = -1;
+
+    if (supported == -1) supported = IsProcessorFeaturePresent( PF_XMMI64_INSTRUCTIONS_AVAILABLE );
+    return supported;
+#endif
+}
+#endif
+
 /* Bayer matrices for dithering */
 
 static const BYTE bayer_4x4[4][4] =
@@ -2204,6 +2231,73 @@ static inline BOOL bit_fields_match(const dib_info *d1, const dib_info *d2)
            d1->blue_mask  == d2->blue_mask;
 }
 
+#ifdef HAVE_DIB_SSE2
+static inline __m128i SSE2_TARGET expand_555_sse2( __m128i val )
+{
+    return _mm_or_si128(
+        _mm_or_si128( _mm_or_si128( _mm_and_si128( _mm_slli_epi32( val, 9 ), _mm_set1_epi32( 0xf80000 )),
+                                    _mm_and_si128( _mm_slli_epi32( val, 4 ), _mm_set1_epi32( 0x070000 ))),
+                      _mm_or_si128( _mm_and_si128( _mm_slli_epi32( val, 6 ), _mm_set1_epi32( 0x00f800 )),
+                                    _mm_and_si128( _mm_slli_epi32( val, 1 ), _mm_set1_epi32( 0x000700 )))),
+        _mm_or_si128( _mm_and_si128( _mm_slli_epi32( val, 3 ), _mm_set1_epi32( 0x0000f8 )),
+                      _mm_and_si128( _mm_srli_epi32( val, 2 ), _mm_set1_epi32( 0x000007 ))));
+}
+
+static int SSE2_TARGET convert_row_555_to_8888_sse2( DWORD *dst, const WORD *src, int width )
+{
+    const __m128i zero = _mm_setzero_si128();
+    int x;
+
+    for (x = 0; x + 8 <= width; x += 8)
+    {
+        __m128i val = _mm_loadu_si128( (const __m128i *)(src + x) );
+
+        _mm_storeu_si128( (__m128i *)(dst + x), expand_555_sse2( _mm_unpacklo_epi16( val, zero )));
+        _mm_storeu_si128( (__m128i *)(dst + x + 4), expand_555_sse2( _mm_unpackhi_epi16( val, zero )));
+    }
+    return x;
+}
+
+static int SSE2_TARGET convert_row_888_to_8888_sse2( DWORD *dst, const DWORD *src, int width,
+                                                     const dib_info *src_dib )
+{
+    const __m128i red_shift = _mm_cvtsi32_si128( src_dib->red_shift );
+    const __m128i green_shift = _mm_cvtsi32_si128( src_dib->green_shift );
+    const __m128i blue_shift = _mm_cvtsi32_si128( src_dib->blue_shift );
+    const __m128i mask = _mm_set1_epi32( 0xff );
+    int x;
+
+    for (x = 0; x + 4 <= width; x += 4)
+    {
+        __m128i val = _mm_loadu_si128( (const __m128i *)(src + x) );
+
+        _mm_storeu_si128( (__m128i *)(dst + x),
+            _mm_or_si128( _mm_or_si128( _mm_slli_epi32( _mm_and_si128( _mm_srl_epi32( val, red_shift ), mask ), 16 ),
+                                        _mm_slli_epi32( _mm_and_si128( _mm_srl_epi32( val, green_shift ), mask ), 8 )),
+                          _mm_and_si128( _mm_srl_epi32( val, blue_shift ), mask )));
+    }
+    return x;
+}
+#endif
+
+/* convert the start of a row with SIMD code if available, return the number of pixels done */
+static inline int convert_row_555_to_8888_simd( DWORD *dst, const WORD *src, int width )
+{
+#ifdef HAVE_DIB_SSE2
+    if (sse2_supported()) return convert_row_555_to_8888_sse2( dst, src, width );
+#endif
+    return 0;
+}
+
+static inline int convert_row_888_to_8888_simd( DWORD *dst, const DWORD *src, int width,
+                                                const dib_info *src_dib )
+{
+#ifdef HAVE_DIB_SSE2
+    if (sse2_supported()) return convert_row_888_to_8888_sse2( dst, src, width, src_dib );
+#endif
+    return 0;
+}
+
 static void convert_to_8888(dib_info *dst, const dib_info *src, const RECT *src_rect, BOOL dither)
 {
     DWORD *dst_start = get_pixel_ptr_32(dst, 0, 0), *dst_pixel, src_val;
@@ -2233,9 +2327,10 @@ static void convert_to_8888(dib_info *dst, const dib_info *src, const RECT *src_
         {
             for(y = src_rect->top; y < src_rect->bottom; y++)
             {
-                dst_pixel = dst_start;
-                src_pixel = src_start;
-                for(x = src_rect->left; x < src_rect->right; x++)
+                x = convert_row_888_to_8888_simd(dst_start, src_start, src_rect->right - src_rect->left, src);
+                dst_pixel = dst_start + x;
+                src_pixel = src_start + x;
+                for(x += src_rect->left; x < src_rect->right; x++)
                 {
                     src_val = *src_pixel++;
                     *dst_pixel++ = (((src_val >> src->red_shift)   & 0xff) << 16) |
@@ -2299,9 +2394,10 @@ static void convert_to_8888(dib_info *dst, const dib_info *src, const RECT *src_
         {
             for(y = src_rect->top; y < src_rect->bottom; y++)
             {
-                dst_pixel = dst_start;
-                src_pixel = src_start;
-                for(x = src_rect->left; x < src_rect->right; x++)
+                x = convert_row_555_to_8888_simd(dst_start, src_start, src_rect->right - src_rect->left);
+                dst_pixel = dst_start + x;
+                src_pixel = src_start + x;
+                for(x += src_rect->left; x < src_rect->right; x++)
                 {
                     src_val = *src_pixel++;
                     *dst_pixel++ = ((src_val << 9) & 0xf80000) | ((src_val << 4) & 0x070000) |
@@ -4654,6 +4750,10 @@ static inline DWORD blend_argb( DWORD dst, DWORD src )
     BYTE g = (BYTE)(src >> 8);
     BYTE r = (BYTE)(src >> 16);
     DWORD alpha  = (BYTE)(src >> 24);
+
+    /* fully opaque and fully transparent pixels are common in alpha images */
+    if (alpha == 255) return src;
+    if (!src) return dst;
     return ((b     + ((BYTE)dst         * (255 - alpha) + 127) / 255) |
             (g     + ((BYTE)(dst >> 8)  * (255 - alpha) + 127) / 255) << 8 |
             (r     + ((BYTE)(dst >> 16) * (255 - alpha) + 127) / 255) << 16 |
@@ -4662,10 +4762,13 @@ static inline DWORD blend_argb( DWORD dst, DWORD src )
 
 static inline DWORD blend_argb_alpha( DWORD dst, DWORD src, DWORD alpha )
 {
-    BYTE b = ((BYTE)src         * alpha + 127) / 255;
-    BYTE g = ((BYTE)(src >> 8)  * alpha + 127) / 255;
-    BYTE r = ((BYTE)(src >> 16) * alpha + 127) / 255;
-    alpha  = ((BYTE)(src >> 24) * alpha + 127) / 255;
+    BYTE b, g, r;
+
+    if (!src) return dst;
+    b     = ((BYTE)src         * alpha + 127) / 255;
+    g     = ((BYTE)(src >> 8)  * alpha + 127) / 255;
+    r     = ((BYTE)(src >> 16) * alpha + 127) / 255;
+    alpha = ((BYTE)(src >> 24) * alpha + 127) / 255;
     return ((b     + ((BYTE)dst         * (255 - alpha) + 127) / 255) |
             (g     + ((BYTE)(dst >> 8)  * (255 - alpha) + 127) / 255) << 8 |
             (r     + ((BYTE)(dst >> 16) * (255 - alpha) + 127) / 255) << 16 |
@@ -4690,6 +4793,84 @@ static inline DWORD blend_rgb( BYTE dst_r, BYTE dst_g, BYTE dst_b, DWORD src, BL
             blend_color( dst_r, src >> 16, blend.SourceConstantAlpha ) << 16);
 }
 
+#ifdef HAVE_DIB_SSE2
+/* (val + 127) / 255 for each 16-bit value up to 255 * 255, same as the scalar code */
+static inline __m128i SSE2_TARGET div255_sse2( __m128i val )
+{
+    val = _mm_add_epi16( val, _mm_set1_epi16( 127 ) );
+    return _mm_srli_epi16( _mm_add_epi16( _mm_add_epi16( val, _mm_set1_epi16( 1 )), _mm_srli_epi16( val, 8 )), 8 );
+}
+
+static inline __m128i SSE2_TARGET broadcast_alpha_sse2( __m128i val )
+{
+    return _mm_shufflehi_epi16( _mm_shufflelo_epi16( val, 0xff ), 0xff );
+}
+
+/* pack channel sums of up to 9 bits, letting a carry spill into the next channel
+ * like the scalar code does when the source isn't premultiplied */
+static inline __m128i SSE2_TARGET pack_channel_sums_sse2( __m128i lo, __m128i hi )
+{
+    const __m128i mask = _mm_set1_epi16( 0xff );
+
+    lo = _mm_or_si128( _mm_and_si128( lo, mask ), _mm_slli_epi64( _mm_srli_epi16( lo, 8 ), 16 ));
+    hi = _mm_or_si128( _mm_and_si128( hi, mask ), _mm_slli_epi64( _mm_srli_epi16( hi, 8 ), 16 ));
+    return _mm_packus_epi16( lo, hi );
+}
+
+static void SSE2_TARGET blend_row_8888_sse2( DWORD *dst, const DWORD *src, int width,
+                                             BLENDFUNCTION blend, BOOL no_src_alpha )
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i ff = _mm_set1_epi16( 0xff );
+    const __m128i alpha = _mm_set1_epi16( blend.SourceConstantAlpha );
+    const __m128i inv_alpha = _mm_set1_epi16( 255 - blend.SourceConstantAlpha );
+    int x;
+
+    for (x = 0; x + 4 <= width; x += 4)
+    {
+        __m128i src_val = _mm_loadu_si128( (const __m128i *)(src + x) );
+        __m128i dst_val = _mm_loadu_si128( (const __m128i *)(dst + x) );
+        __m128i src_lo, src_hi, dst_lo, dst_hi;
+
+        if (no_src_alpha) src_val = _mm_or_si128( src_val, _mm_set1_epi32( 0xff000000 ));
+        src_lo = _mm_unpacklo_epi8( src_val, zero );
+        src_hi = _mm_unpackhi_epi8( src_val, zero );
+        dst_lo = _mm_unpacklo_epi8( dst_val, zero );
+        dst_hi = _mm_unpackhi_epi8( dst_val, zero );
+
+        if (blend.AlphaFormat & AC_SRC_ALPHA)
+        {
+            if (blend.SourceConstantAlpha != 255)
+            {
+                src_lo = div255_sse2( _mm_mullo_epi16( src_lo, alpha ));
+                src_hi = div255_sse2( _mm_mullo_epi16( src_hi, alpha ));
+            }
+            dst_lo = div255_sse2( _mm_mullo_epi16( dst_lo, _mm_sub_epi16( ff, broadcast_alpha_sse2( src_lo ))));
+            dst_hi = div255_sse2( _mm_mullo_epi16( dst_hi, _mm_sub_epi16( ff, broadcast_alpha_sse2( src_hi ))));
+            dst_val = pack_channel_sums_sse2( _mm_add_epi16( src_lo, dst_lo ), _mm_add_epi16( src_hi, dst_hi ));
+        }
+        else
+        {
+            dst_lo = div255_sse2( _mm_add_epi16( _mm_mullo_epi16( src_lo, alpha ), _mm_mullo_epi16( dst_lo, inv_alpha )));
+            dst_hi = div255_sse2( _mm_add_epi16( _mm_mullo_epi16( src_hi, alpha ), _mm_mullo_epi16( dst_hi, inv_alpha )));
+            dst_val = _mm_packus_epi16( dst_lo, dst_hi );
+        }
+        _mm_storeu_si128( (__m128i *)(dst + x), dst_val );
+    }
+
+    for (; x < width; x++)
+    {
+        if (!(blend.AlphaFormat & AC_SRC_ALPHA))
+            dst[x] = no_src_alpha ? blend_argb_no_src_alpha( dst[x], src[x], blend.SourceConstantAlpha )
+                                  : blend_argb_constant_alpha( dst[x], src[x], blend.SourceConstantAlpha );
+        else if (blend.SourceConstantAlpha == 255)
+            dst[x] = blend_argb( dst[x], src[x] );
+        else
+            dst[x] = blend_argb_alpha( dst[x], src[x], blend.SourceConstantAlpha );
+    }
+}
+#endif
+
 static void blend_rect_8888(const dib_info *dst, const RECT *rc,
                             const dib_info *src, const POINT *origin, BLENDFUNCTION blend)
 {
@@ -4697,6 +4878,19 @@ static void blend_rect_8888(const dib_info *dst, const RECT *rc,
     DWORD *dst_ptr = get_pixel_ptr_32( dst, rc->left, rc->top );
     int x, y;
 
+    if (!blend.SourceConstantAlpha) return;  /* destination is left unchanged */
+
+#ifdef HAVE_DIB_SSE2
+    if (sse2_supported())
+    {
+        BOOL no_src_alpha = !(blend.AlphaFormat & AC_SRC_ALPHA) && src->compression != BI_RGB;
+
+        for (y = rc->top; y < rc->bottom; y++, dst_ptr += dst->stride / 4, src_ptr += src->stride / 4)
+            blend_row_8888_sse2( dst_ptr, src_ptr, rc->right - rc->left, blend, no_src_alpha );
+        return;
+    }
+#endif
+
     if (blend.AlphaFormat & AC_SRC_ALPHA)
     {
 	if (blend.SourceConstantAlpha == 255)
@@ -581,6 +581,7 @@ static const WCHAR face_internal_leading_value[] = {'I','n','t','e','r','n','a',
 static const WCHAR face_font_sig_value[] = {'F','o','n','t',' ','S','i','g','n','a','t','u','r','e',0};
 static const WCHAR face_file_name_value[] = {'F','i','l','e',' ','N','a','m','e','\0'};
 static const WCHAR face_full_name_value[] = {'F','u','l','l',' ','N','a','m','e','\0'};
+static const WCHAR font_cache_data_value[] = {'P','a','c','k','e','d',' ','D','a','t','a',0};
 
 
 struct font_mapping
@@ -609,6 +610,7 @@ static CRITICAL_SECTION_DEBUG critsect_debug =
 static CRITICAL_SECTION freetype_cs = { &critsect_debug, -1, 0, 0, 0, 0 };
 
 static const WCHAR font_mutex_nameW[] = {'_','_','W','I','N','E','_','F','O','N','T','_','M','U','T','E','X','_','_','\0'};
+static HANDLE font_mutex;
 
 static const WCHAR szDefaultFallbackLink[] = {'M','i','c','r','o','s','o','f','t',' ','S','a','n','s',' ','S','e','r','i','f',0};
 static BOOL use_default_fallback = FALSE;
@@ -1626,7 +1628,149 @@ static inline LONG reg_save_dword(HKEY hkey, const WCHAR *value, DWORD data)
     return RegSetValueExW(hkey, value, 0, REG_DWORD, (BYTE*)&data, sizeof(DWORD));
 }
 
-static void load_face(HKEY hkey_face, WCHAR *face_name, Family *family, void *buffer, DWORD buffer_size)
+/* packed copy of the font cache, see load_font_list_from_cache_data */
+struct cache_data
+{
+    BYTE  *data;
+    DWORD  size;
+    DWORD  alloc;
+};
+
+#define CACHE_DATA_VERSION  1
+#define CACHE_RECORD_FAMILY 1
+#define CACHE_RECORD_FACE   2
+
+static void cache_data_add( struct cache_data *cache, const void *ptr, DWORD size )
+{
+    if (!cache->data) return;
+    if (cache->size + size > cache->alloc)
+    {
+        DWORD new_alloc = max( cache->alloc * 2, cache->size + size );
+        BYTE *new_data = HeapReAlloc( GetProcessHeap(), 0, cache->data, new_alloc );
+
+        if (!new_data)
+        {
+            HeapFree( GetProcessHeap(), 0, cache->data );
+            cache->data = NULL;
+            return;
+        }
+        cache->data = new_data;
+        cache->alloc = new_alloc;
+    }
+    memcpy( cache->data + cache->size, ptr, size );
+    cache->size += size;
+}
+
+static inline void cache_data_add_dword( struct cache_data *cache, DWORD value )
+{
+    cache_data_add( cache, &value, sizeof(value) );
+}
+
+static void cache_data_add_string( struct cache_data *cache, const WCHAR *str )
+{
+    static const WCHAR padding;
+    DWORD len = str ? strlenW( str ) + 1 : 0;
+
+    cache_data_add_dword( cache, len );
+    cache_data_add( cache, str, len * sizeof(WCHAR) );
+    if (len & 1) cache_data_add( cache, &padding, sizeof(padding) );  /* keep dwords aligned */
+}
+
+static void cache_data_add_face( struct cache_data *cache, const Face *face )
+{
+    cache_data_add_dword( cache, CACHE_RECORD_FACE );
+    cache_data_add_string( cache, face->StyleName );
+    cache_data_add_string( cache, face->file );
+    cache_data_add_string( cache, face->FullName );
+    cache_data_add_dword( cache, face->face_index );
+    cache_data_add_dword( cache, face->ntmFlags );
+    cache_data_add_dword( cache, face->font_version );
+    cache_data_add_dword( cache, face->flags );
+    cache_data_add( cache, &face->fs, sizeof(face->fs) );
+    cache_data_add_dword( cache, face->scalable );
+    if (!face->scalable)
+    {
+        cache_data_add_dword( cache, face->size.height );
+        cache_data_add_dword( cache, face->size.width );
+        cache_data_add_dword( cache, face->size.size );
+        cache_data_add_dword( cache, face->size.x_ppem );
+        cache_data_add_dword( cache, face->size.y_ppem );
+        cache_data_add_dword( cache, face->size.internal_leading );
+    }
+}
+
+static BOOL cache_data_get( const BYTE **ptr, const BYTE *end, void *data, DWORD size )
+{
+    if ((DWORD)(end - *ptr) < size) return FALSE;
+    memcpy( data, *ptr, size );
+    *ptr += size;
+    return TRUE;
+}
+
+static inline BOOL cache_data_get_dword( const BYTE **ptr, const BYTE *end, DWORD *value )
+{
+    return cache_data_get( ptr, end, value, sizeof(*value) );
+}
+
+static BOOL cache_data_get_string( const BYTE **ptr, const BYTE *end, const WCHAR **str )
+{
+    DWORD len, size;
+
+    if (!cache_data_get_dword( ptr, end, &len )) return FALSE;
+    *str = NULL;
+    if (!len) return TRUE;
+    size = (len + (len & 1)) * sizeof(WCHAR);
+    if (len > (DWORD)(end - *ptr) / sizeof(WCHAR) || size > (DWORD)(end - *ptr)) return FALSE;
+    *str = (const WCHAR *)*ptr;
+    *ptr += size;
+    return !(*str)[len - 1];
+}
+
+static Family *add_family_from_cache( WCHAR *family_name, WCHAR *english_family, struct cache_data *cache )
+{
+    Family *family = create_family( family_name, english_family );
+
+    if (english_family)
+    {
+        FontSubst *subst = HeapAlloc(GetProcessHeap(), 0, sizeof(*subst));
+        subst->from.name = strdupW(english_family);
+        subst->from.charset = -1;
+        subst->to.name = strdupW(family_name);
+        subst->to.charset = -1;
+        add_font_subst(&font_subst_list, subst, 0);
+    }
+
+    if (cache)
+    {
+        cache_data_add_dword( cache, CACHE_RECORD_FAMILY );
+        cache_data_add_string( cache, family_name );
+        cache_data_add_string( cache, english_family );
+    }
+    return family;
+}
+
+static void add_face_from_cache( Face *face, Family *family, struct cache_data *cache )
+{
+    if (!face->scalable)
+        TRACE("Adding bitmap size h %d w %d size %ld x_ppem %ld y_ppem %ld\n",
+              face->size.height, face->size.width, face->size.size >> 6,
+              face->size.x_ppem >> 6, face->size.y_ppem >> 6);
+
+    TRACE("fsCsb = %08x %08x/%08x %08x %08x %08x\n",
+          face->fs.fsCsb[0], face->fs.fsCsb[1],
+          face->fs.fsUsb[0], face->fs.fsUsb[1],
+          face->fs.fsUsb[2], face->fs.fsUsb[3]);
+
+    if (cache) cache_data_add_face( cache, face );
+
+    if (insert_face_in_family_list(face, family))
+        TRACE("Added font %s %s\n", debugstr_w(family->FamilyName), debugstr_w(face->StyleName));
+
+    release_face( face );
+}
+
+static void load_face(HKEY hkey_face, WCHAR *face_name, Family *family, void *buffer, DWORD buffer_size,
+                      struct cache_data *cache)
 {
     DWORD needed, strike_index = 0;
     HKEY hkey_strike;
@@ -1672,21 +1816,9 @@ static void load_face(HKEY hkey_face, WCHAR *face_name, Family *family, void *bu
             reg_load_ftlong(hkey_face, face_x_ppem_value, &face->size.x_ppem);
             reg_load_ftlong(hkey_face, face_y_ppem_value, &face->size.y_ppem);
             reg_load_ftshort(hkey_face, face_internal_leading_value, &face->size.internal_leading);
-
-            TRACE("Adding bitmap size h %d w %d size %ld x_ppem %ld y_ppem %ld\n",
-                  face->size.height, face->size.width, face->size.size >> 6,
-                  face->size.x_ppem >> 6, face->size.y_ppem >> 6);
         }
 
-        TRACE("fsCsb = %08x %08x/%08x %08x %08x %08x\n",
-              face->fs.fsCsb[0], face->fs.fsCsb[1],
-              face->fs.fsUsb[0], face->fs.fsUsb[1],
-              face->fs.fsUsb[2], face->fs.fsUsb[3]);
-
-        if (insert_face_in_family_list(face, family))
-            TRACE("Added font %s %s\n", debugstr_w(family->FamilyName), debugstr_w(face->StyleName));
-
-        release_face( face );
+        add_face_from_cache( face, family, cache );
     }
 
     /* load bitmap strikes */
@@ -1696,7 +1828,7 @@ static void load_face(HKEY hkey_face, WCHAR *face_name, Family *family, void *bu
     {
         if (!RegOpenKeyExW(hkey_face, buffer, 0, KEY_ALL_ACCESS, &hkey_strike))
         {
-            load_face(hkey_strike, face_name, family, buffer, buffer_size);
+            load_face(hkey_strike, face_name, family, buffer, buffer_size, cache);
             RegCloseKey(hkey_strike);
         }
         needed = buffer_size;
@@ -1741,6 +1873,12 @@ static void load_font_list_from_cache(HKEY hkey_font_cache)
     Family *family;
     HKEY hkey_family;
     WCHAR buffer[4096];
+    struct cache_data cache;
+
+    cache.size = 0;
+    cache.alloc = 65536;
+    if ((cache.data = HeapAlloc( GetProcessHeap(), 0, cache.alloc )))
+        cache_data_add_dword( &cache, CACHE_DATA_VERSION );
 
     size = sizeof(buffer);
     while (!RegEnumKeyExW(hkey_font_cache, family_index++, buffer, &size, NULL, NULL, NULL, NULL))
@@ -1755,17 +1893,7 @@ static void load_font_list_from_cache(HKEY hkey_font_cache)
         if (!RegQueryValueExW(hkey_family, english_name_value, NULL, NULL, (BYTE *)buffer, &size))
             english_family = strdupW( buffer );
 
-        family = create_family(family_name, english_family);
-
-        if(english_family)
-        {
-            FontSubst *subst = HeapAlloc(GetProcessHeap(), 0, sizeof(*subst));
-            subst->from.name = strdupW(english_family);
-            subst->from.charset = -1;
-            subst->to.name = strdupW(family_name);
-            subst->to.charset = -1;
-            add_font_subst(&font_subst_list, subst, 0);
-        }
+        family = add_family_from_cache( family_name, english_family, &cache );
 
         size = sizeof(buffer);
         while (!RegEnumKeyExW(hkey_family, face_index++, buffer, &size, NULL, NULL, NULL, NULL))
@@ -1775,7 +1903,7 @@ static void load_font_list_from_cache(HKEY hkey_font_cache)
 
             if (!RegOpenKeyExW(hkey_family, face_name, 0, KEY_ALL_ACCESS, &hkey_face))
             {
-                load_face(hkey_face, face_name, family, buffer, sizeof(buffer));
+                load_face(hkey_face, face_name, family, buffer, sizeof(buffer), &cache);
                 RegCloseKey(hkey_face);
             }
             HeapFree( GetProcessHeap(), 0, face_name );
@@ -1787,6 +1915,112 @@ static void load_font_list_from_cache(HKEY hkey_font_cache)
     }
 
     reorder_vertical_fonts();
+
+    /* store the packed data so that the next processes can use load_font_list_from_cache_data */
+    if (cache.data)
+    {
+        RegSetValueExW( hkey_font_cache, font_cache_data_value, 0, REG_BINARY, cache.data, cache.size );
+        HeapFree( GetProcessHeap(), 0, cache.data );
+    }
+}
+
+static BOOL parse_font_cache_data( const BYTE *ptr, const BYTE *end, BOOL create )
+{
+    const WCHAR *family_name, *english_family, *style_name, *file, *full_name;
+    Family *family = NULL;
+    BOOL seen_family = FALSE;
+    DWORD type, scalable, value[6];
+    FONTSIGNATURE fs;
+    Face *face;
+
+    if (!cache_data_get_dword( &ptr, end, &type ) || type != CACHE_DATA_VERSION) return FALSE;
+
+    while (ptr < end)
+    {
+        if (!cache_data_get_dword( &ptr, end, &type )) return FALSE;
+        switch (type)
+        {
+        case CACHE_RECORD_FAMILY:
+            if (!cache_data_get_string( &ptr, end, &family_name ) || !family_name) return FALSE;
+            if (!cache_data_get_string( &ptr, end, &english_family )) return FALSE;
+            seen_family = TRUE;
+            if (!create) break;
+            if (family) release_family( family );
+            family = add_family_from_cache( strdupW( family_name ),
+                                            english_family ? strdupW( english_family ) : NULL, NULL );
+            break;
+
+        case CACHE_RECORD_FACE:
+            if (!seen_family) return FALSE;
+            if (!cache_data_get_string( &ptr, end, &style_name ) || !style_name) return FALSE;
+            if (!cache_data_get_string( &ptr, end, &file ) || !file) return FALSE;
+            if (!cache_data_get_string( &ptr, end, &full_name )) return FALSE;
+            if (!cache_data_get( &ptr, end, value, 4 * sizeof(DWORD) )) return FALSE;
+            if (!cache_data_get( &ptr, end, &fs, sizeof(fs) )) return FALSE;
+            if (!cache_data_get_dword( &ptr, end, &scalable )) return FALSE;
+            if (!create)
+            {
+                if (!scalable && !cache_data_get( &ptr, end, value, 6 * sizeof(DWORD) )) return FALSE;
+                break;
+            }
+
+            face = HeapAlloc(GetProcessHeap(), 0, sizeof(*face));
+            face->cached_enum_data = NULL;
+            face->family = NULL;
+            face->refcount = 1;
+            face->file = strdupW( file );
+            face->StyleName = strdupW( style_name );
+            face->FullName = full_name ? strdupW( full_name ) : NULL;
+            face->face_index = value[0];
+            face->ntmFlags = value[1];
+            face->font_version = value[2];
+            face->flags = value[3];
+            face->fs = fs;
+            face->scalable = scalable;
+            memset(&face->size, 0, sizeof(face->size));
+            if (!scalable)
+            {
+                cache_data_get( &ptr, end, value, 6 * sizeof(DWORD) );
+                face->size.height = value[0];
+                face->size.width = value[1];
+                face->size.size = value[2];
+                face->size.x_ppem = value[3];
+                face->size.y_ppem = value[4];
+                face->size.internal_leading = value[5];
+            }
+            add_face_from_cache( face, family, NULL );
+            break;
+
+        default:
+            return FALSE;
+        }
+    }
+    if (family) release_family( family );
+    return TRUE;
+}
+
+/* load the font list from the packed copy of the cache stored by load_font_list_from_cache,
+ * which only needs one value query instead of one per cached value and key */
+static BOOL load_font_list_from_cache_data(HKEY hkey_font_cache)
+{
+    DWORD type, size = 0;
+    BYTE *data;
+    BOOL ret = FALSE;
+
+    if (RegQueryValueExW( hkey_font_cache, font_cache_data_value, NULL, &type, NULL, &size ) ||
+        type != REG_BINARY)
+        return FALSE;
+    if (!(data = HeapAlloc( GetProcessHeap(), 0, size ))) return FALSE;
+
+    if (!RegQueryValueExW( hkey_font_cache, font_cache_data_value, NULL, &type, data, &size ) &&
+        type == REG_BINARY && parse_font_cache_data( data, data + size, FALSE ))
+    {
+        parse_font_cache_data( data, data + size, TRUE );
+        reorder_vertical_fonts();
+        ret = TRUE;
+    }
+    HeapFree( GetProcessHeap(), 0, data );
+    return ret;
 }
 
 static LONG create_font_cache_key(HKEY *hkey, DWORD *disposition)
@@ -1809,11 +2043,25 @@ static LONG create_font_cache_key(HKEY *hkey, DWORD *disposition)
     return ret;
 }
 
+/* the cache data has to be invalidated whenever a face is added or removed,
+ * the font mutex protects it against concurrent rebuilds by other processes */
+static void lock_font_cache(void)
+{
+    if (font_mutex) WaitForSingleObject( font_mutex, INFINITE );
+}
+
+static void unlock_font_cache(void)
+{
+    RegDeleteValueW( hkey_font_cache, font_cache_data_value );
+    if (font_mutex) ReleaseMutex( font_mutex );
+}
+
 static void add_face_to_cache(Face *face)
 {
     HKEY hkey_family, hkey_face;
     WCHAR *face_key_name;
 
+    lock_font_cache();
     RegCreateKeyExW(hkey_font_cache, face->family->FamilyName, 0,
                     NULL, REG_OPTION_VOLATILE, KEY_ALL_ACCESS, NULL, &hkey_family, NULL);
     if(face->family->EnglishName)
@@ -1857,12 +2105,14 @@ static void add_face_to_cache(Face *face)
     }
     RegCloseKey(hkey_face);
     RegCloseKey(hkey_family);
+    unlock_font_cache();
 }
 
 static void remove_face_from_cache( Face *face )
 {
     HKEY hkey_family;
 
+    lock_font_cache();
     RegOpenKeyExW( hkey_font_cache, face->family->FamilyName, 0, KEY_ALL_ACCESS, &hkey_family );
 
     if (face->scalable)
@@ -1878,6 +2128,7 @@ static void remove_face_from_cache( Face *face )
         HeapFree(GetProcessHeap(), 0, face_key_name);
     }
     RegCloseKey(hkey_family);
+    unlock_font_cache();
 }
 
 static WCHAR *prepend_at(WCHAR *family)
@@ -4354,7 +4605,6 @@ BOOL WineEngInit(void)
 {
     HKEY hkey;
     DWORD disposition;
-    HANDLE font_mutex;
 
     /* update locale dependent font info in registry */
     update_font_info();
@@ -4393,7 +4643,7 @@ BOOL WineEngInit(void)
 
     if(disposition == REG_CREATED_NEW_KEY)
         init_font_list();
-    else
+    else if (!load_font_list_from_cache_data(hkey_font_cache))
         load_font_list_from_cache(hkey_font_cache);
 
     reorder_font_list();
@@ -39,6 +39,7 @@
 #define HEAP_VALIDATE_PARAMS  0x40000000
 
 static BOOL (WINAPI *pHeapQueryInformation)(HANDLE, HEAP_INFORMATION_CLASS, PVOID, SIZE_T, PSIZE_T);
+static BOOL (WINAPI *pHeapSetInformation)(HANDLE, HEAP_INFORMATION_CLASS, PVOID, SIZE_T);
 static BOOL (WINAPI *pGetPhysicallyInstalledSystemMemory)(ULONGLONG *);
 static ULONG (WINAPI *pRtlGetNtGlobalFlags)(void);
 
@@ -867,6 +868,102 @@ static void test_HeapQueryInformation(void)
     ok(info == 0 || info == 1 || info == 2, "expected 0, 1 or 2, got %u\n", info);
 }
 
+static void test_low_fragmentation_heap(void)
+{
+    static const SIZE_T sizes[] = { 1, 8, 17, 100, 256, 1000, 4000, 16000 };
+    BYTE *ptrs[sizeof(sizes) / sizeof(sizes[0])][16];
+    PROCESS_HEAP_ENTRY entry;
+    HANDLE heap;
+    ULONG info;
+    SIZE_T size;
+    BOOL ret;
+    int i, j;
+
+    pHeapSetInformation = (void *)GetProcAddress(GetModuleHandleA("kernel32.dll"), "HeapSetInformation");
+    if (!pHeapSetInformation || !pHeapQueryInformation)
+    {
+        win_skip("HeapSetInformation is not available\n");
+        return;
+    }
+
+    heap = HeapCreate(0, 0, 0);
+    ok(heap != NULL, "HeapCreate failed\n");
+
+    info = 2;
+    SetLastError(0xdeadbeef);
+    ret = pHeapSetInformation(heap, HeapCompatibilityInformation, &info, sizeof(info));
+    ok(ret, "HeapSetInformation error %u\n", GetLastError());
+
+    info = 0xdeadbeef;
+    ret = pHeapQueryInformation(heap, HeapCompatibilityInformation, &info, sizeof(info), NULL);
+    ok(ret, "HeapQueryInformation error %u\n", GetLastError());
+    ok(info == 2, "expected 2, got %u\n", info);
+
+    /* allocate, free and reallocate blocks of various sizes */
+    for (i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++)
+    {
+        for (j = 0; j < 16; j++)
+        {
+            ptrs[i][j] = HeapAlloc(heap, 0, sizes[i]);
+            ok(ptrs[i][j] != NULL, "HeapAlloc failed for size %lu\n", sizes[i]);
+            memset(ptrs[i][j], 0xcc, sizes[i]);
+        }
+        for (j = 0; j < 16; j += 2)
+        {
+            ret = HeapFree(heap, 0, ptrs[i][j]);
+            ok(ret, "HeapFree failed for size %lu\n", sizes[i]);
+        }
+
+        /* freed blocks may be cached, but the heap must still be consistent */
+        ret = HeapValidate(heap, 0, NULL);
+        ok(ret, "HeapValidate failed for size %lu\n", sizes[i]);
+        ret = HeapValidate(heap, 0, ptrs[i][1]);
+        ok(ret, "HeapValidate failed for block of size %lu\n", sizes[i]);
+
+        memset(&entry, 0, sizeof(entry));
+        while ((ret = HeapWalk(heap, &entry)))
+        {
+            for (j = 0; j < 16; j += 2)
+                ok(entry.lpData != ptrs[i][j] || !(entry.wFlags & PROCESS_HEAP_ENTRY_BUSY),
+                   "freed block %p of size %lu reported as busy\n", ptrs[i][j], sizes[i]);
+        }
+        ok(GetLastError() == ERROR_NO_MORE_ITEMS, "HeapWalk error %u\n", GetLastError());
+
+        for (j = 0; j < 16; j += 2)
+        {
+            ptrs[i][j] = HeapAlloc(heap, HEAP_ZERO_MEMORY, sizes[i]);
+            ok(ptrs[i][j] != NULL, "HeapAlloc failed for size %lu\n", sizes[i]);
+            size = HeapSize(heap, 0, ptrs[i][j]);
+            ok(size == sizes[i], "expected size %lu, got %lu\n", sizes[i], size);
+            ok(!ptrs[i][j][0] && !ptrs[i][j][sizes[i] - 1], "block for size %lu not zeroed\n", sizes[i]);
+        }
+    }
+    for (i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++)
+        for (j = 0; j < 16; j++)
+        {
+            ret = HeapFree(heap, 0, ptrs[i][j]);
+            ok(ret, "HeapFree failed for size %lu\n", sizes[i]);
+        }
+
+    HeapDestroy(heap);
+
+    /* not supported on heaps without serialization */
+    heap = HeapCreate(HEAP_NO_SERIALIZE, 0, 0);
+    ok(heap != NULL, "HeapCreate failed\n");
+
+    info = 2;
+    SetLastError(0xdeadbeef);
+    ret = pHeapSetInformation(heap, HeapCompatibilityInformation, &info, sizeof(info));
+    ok(!ret, "HeapSetInformation succeeded\n");
+
+    info = 0xdeadbeef;
+    ret = pHeapQueryInformation(heap, HeapCompatibilityInformation, &info, sizeof(info), NULL);
+    ok(ret, "HeapQueryInformation error %u\n", GetLastError());
+    ok(info == 0, "expected 0, got %u\n", info);
+
+    HeapDestroy(heap);
+}
+
 static void test_heap_checks( DWORD flags )
 {
     BYTE old, *p, *p2;
@@ -1220,6 +1317,7 @@ START_TEST(heap)
     test_sized_HeapReAlloc((1 << 20), 1);
 
     test_HeapQueryInformation();
+    test_low_fragmentation_heap();
     test_GetPhysicallyInstalledSystemMemory();
 
     if (pRtlGetNtGlobalFlags)
@@ -199,6 +199,33 @@ static const unsigned int dir_data_names_initial_size  = 64;
 static struct dir_data **dir_data_cache;
 static unsigned int dir_data_cache_size;
 
+/* case-insensitive name index of a directory, used to speed up find_file_in_dir */
+struct dir_index_entry
+{
+    struct dir_index_entry *next;      /* next entry in the hash bucket */
+    const char             *unix_name; /* Unix file name in host encoding */
+    unsigned int            len;       /* length of the Unicode name */
+    WCHAR                   name[1];   /* lower-case Unicode name */
+};
+
+struct dir_index
+{
+    struct list              entry;    /* entry in the cached indexes list, most recently used first */
+    struct file_identity     id;       /* directory file identity */
+    time_t                   mtime;    /* directory modification time when the index was built */
+    unsigned int             count;    /* number of names in the index */
+    unsigned int             hash_size; /* number of hash buckets, a power of 2 */
+    struct dir_index_entry **buckets;  /* hash buckets, NULL for a small directory */
+};
+
+#define DIR_INDEX_MIN_NAMES  64   /* don't keep indexes of small directories */
+#define DIR_INDEX_CACHE_SIZE 16   /* max number of cached indexes */
+#define DIR_INDEX_SMALL_SIZE 64   /* max number of cached small directories */
+
+static struct list dir_index_cache = LIST_INIT( dir_index_cache );
+static unsigned int dir_index_cache_count;
+static unsigned int dir_index_small_count;
+
 static BOOL show_dot_files;
 static RTL_RUN_ONCE init_once = RTL_RUN_ONCE_INIT;
 
@@ -2073,6 +2100,260 @@ NTSTATUS WINAPI NtQueryDirectoryFile( HANDLE handle, HANDLE event,
 }
 
 
+/***********************************************************************
+ *           hash_dir_index_name
+ */
+static inline unsigned int hash_dir_index_name( const WCHAR *name, unsigned int len )
+{
+    unsigned int i, hash = 0;
+
+    for (i = 0; i < len; i++) hash = hash * 31 + name[i];
+    return hash;
+}
+
+
+/***********************************************************************
+ *           free_dir_index_names
+ */
+static void free_dir_index_names( struct dir_index *index )
+{
+    unsigned int i;
+    struct dir_index_entry *entry, *next;
+
+    for (i = 0; i < index->hash_size; i++)
+    {
+        for (entry = index->buckets[i]; entry; entry = next)
+        {
+            next = entry->next;
+            RtlFreeHeap( GetProcessHeap(), 0, entry );
+        }
+    }
+    RtlFreeHeap( GetProcessHeap(), 0, index->buckets );
+    index->buckets = NULL;
+    index->hash_size = 0;
+}
+
+
+/***********************************************************************
+ *           free_dir_index
+ */
+static void free_dir_index( struct dir_index *index )
+{
+    free_dir_index_names( index );
+    RtlFreeHeap( GetProcessHeap(), 0, index );
+}
+
+
+/***********************************************************************
+ *           remove_dir_index
+ *
+ * Remove an index from the cache and free it. dir_section must be held.
+ */
+static void remove_dir_index( struct dir_index *index )
+{
+    list_remove( &index->entry );
+    if (index->buckets) dir_index_cache_count--;
+    else dir_index_small_count--;
+    free_dir_index( index );
+}
+
+
+/***********************************************************************
+ *           add_dir_index
+ *
+ * Add an index to the cache, evicting the least recently used one of the same kind
+ * if necessary. Small directories are only remembered so that they are not read again.
+ * dir_section must be held.
+ */
+static void add_dir_index( struct dir_index *index )
+{
+    unsigned int *count = index->buckets ? &dir_index_cache_count : &dir_index_small_count;
+    unsigned int max = index->buckets ? DIR_INDEX_CACHE_SIZE : DIR_INDEX_SMALL_SIZE;
+    struct dir_index *cur;
+
+    if (*count == max)
+    {
+        LIST_FOR_EACH_ENTRY_REV( cur, &dir_index_cache, struct dir_index, entry )
+        {
+            if (!cur->buckets != !index->buckets) continue;
+            remove_dir_index( cur );
+            break;
+        }
+    }
+    list_add_head( &dir_index_cache, &index->entry );
+    (*count)++;
+}
+
+
+/***********************************************************************
+ *           add_dir_index_name
+ */
+static BOOL add_dir_index_name( struct dir_index *index, const char *unix_name )
+{
+    WCHAR buffer[MAX_DIR_ENTRY_LEN];
+    struct dir_index_entry *entry, **bucket;
+    unsigned int i, len, unix_len = strlen( unix_name );
+    int ret;
+
+    if (index->count >= index->hash_size)  /* grow the hash table */
+    {
+        unsigned int new_size = index->hash_size * 2;
+        struct dir_index_entry **buckets, *next;
+
+        if (!(buckets = RtlAllocateHeap( GetProcessHeap(), HEAP_ZERO_MEMORY, new_size * sizeof(*buckets) )))
+            return FALSE;
+        for (i = 0; i < index->hash_size; i++)
+        {
+            /* keep the directory order within each bucket */
+            for (entry = index->buckets[i]; entry; entry = next)
+            {
+                next = entry->next;
+                bucket = &buckets[hash_dir_index_name( entry->name, entry->len ) & (new_size - 1)];
+                while (*bucket) bucket = &(*bucket)->next;
+                *bucket = entry;
+                entry->next = NULL;
+            }
+        }
+        RtlFreeHeap( GetProcessHeap(), 0, index->buckets );
+        index->buckets = buckets;
+        index->hash_size = new_size;
+    }
+
+    if ((ret = ntdll_umbstowcs( 0, unix_name, unix_len, buffer, MAX_DIR_ENTRY_LEN )) < 0) return TRUE;
+    len = ret;
+
+    if (!(entry = RtlAllocateHeap( GetProcessHeap(), 0,
+                                   offsetof( struct dir_index_entry, name[len] ) + unix_len + 1 )))
+        return FALSE;
+    for (i = 0; i < len; i++) entry->name[i] = tolowerW( buffer[i] );
+    entry->len = len;
+    entry->unix_name = (char *)&entry->name[len];
+    memcpy( (char *)entry->unix_name, unix_name, unix_len + 1 );
+    entry->next = NULL;
+
+    bucket = &index->buckets[hash_dir_index_name( entry->name, len ) & (index->hash_size - 1)];
+    while (*bucket) bucket = &(*bucket)->next;
+    *bucket = entry;
+    index->count++;
+    return TRUE;
+}
+
+
+/***********************************************************************
+ *           create_dir_index
+ *
+ * Build the case-insensitive name index of a directory.
+ */
+static struct dir_index *create_dir_index( const char *unix_name, const struct stat *st )
+{
+    struct dir_index *index;
+    struct dirent *de;
+    DIR *dir;
+
+    if (!(dir = opendir( unix_name ))) return NULL;
+
+    if (!(index = RtlAllocateHeap( GetProcessHeap(), 0, sizeof(*index) ))) goto failed;
+    index->id.dev    = st->st_dev;
+    index->id.ino    = st->st_ino;
+    index->mtime     = st->st_mtime;
+    index->count     = 0;
+    index->hash_size = DIR_INDEX_MIN_NAMES;
+    if (!(index->buckets = RtlAllocateHeap( GetProcessHeap(), HEAP_ZERO_MEMORY,
+                                            index->hash_size * sizeof(*index->buckets) )))
+    {
+        RtlFreeHeap( GetProcessHeap(), 0, index );
+        goto failed;
+    }
+
+    while ((de = readdir( dir )))
+    {
+        if (!add_dir_index_name( index, de->d_name ))
+        {
+            free_dir_index( index );
+            goto failed;
+        }
+    }
+    closedir( dir );
+    return index;
+
+failed:
+    closedir( dir );
+    return NULL;
+}
+
+
+/***********************************************************************
+ *           find_dir_index_name
+ *
+ * Look up a name in the cached index of a directory, building the index if necessary.
+ * The unix name of the file found is copied to the buffer.
+ * Returns STATUS_OBJECT_PATH_NOT_FOUND if the file doesn't exist, STATUS_NOT_IMPLEMENTED
+ * if the directory index can't be used, in which case the caller scans the directory.
+ */
+static NTSTATUS find_dir_index_name( const char *unix_name, const WCHAR *name, int length,
+                                     char *buffer )
+{
+    WCHAR lower[MAX_DIR_ENTRY_LEN];
+    struct dir_index *index = NULL, *cur;
+    struct dir_index_entry *entry;
+    NTSTATUS status = STATUS_OBJECT_PATH_NOT_FOUND;
+    struct stat st;
+    int i;
+
+    if (length > MAX_DIR_ENTRY_LEN) return STATUS_OBJECT_PATH_NOT_FOUND;
+    if (stat( unix_name, &st ) == -1) return STATUS_NOT_IMPLEMENTED;
+
+    /* an index built while the directory was being modified may miss a later change
+     * that doesn't update the modification time, so only index quiescent directories */
+    if (st.st_mtime >= time( NULL ) - 1) return STATUS_NOT_IMPLEMENTED;
+
+    RtlEnterCriticalSection( &dir_section );
+
+    LIST_FOR_EACH_ENTRY( cur, &dir_index_cache, struct dir_index, entry )
+    {
+        if (cur->id.dev != st.st_dev || cur->id.ino != st.st_ino) continue;
+        if (cur->mtime == st.st_mtime)
+        {
+            index = cur;
+            list_remove( &index->entry );
+            list_add_head( &dir_index_cache, &index->entry );
+        }
+        else remove_dir_index( cur );  /* directory has changed */
+        break;
+    }
+
+    if (!index)
+    {
+        if (!(index = create_dir_index( unix_name, &st )))
+        {
+            RtlLeaveCriticalSection( &dir_section );
+            return STATUS_NOT_IMPLEMENTED;
+        }
+        if (index->count < DIR_INDEX_MIN_NAMES) free_dir_index_names( index );
+        add_dir_index( index );
+    }
+
+    if (!index->buckets)  /* small directory, a linear scan is cheaper */
+    {
+        RtlLeaveCriticalSection( &dir_section );
+        return STATUS_NOT_IMPLEMENTED;
+    }
+
+    for (i = 0; i < length; i++) lower[i] = tolowerW( name[i] );
+    for (entry = index->buckets[hash_dir_index_name( lower, length ) & (index->hash_size - 1)];
+         entry; entry = entry->next)
+    {
+        if (entry->len != length || memcmp( entry->name, lower, length * sizeof(WCHAR) )) continue;
+        strcpy( buffer, entry->unix_name );
+        status = STATUS_SUCCESS;
+        break;
+    }
+
+    RtlLeaveCriticalSection( &dir_section );
+    return status;
+}
+
+
 /***********************************************************************
  *           find_file_in_dir
  *
@@ -2089,6 +2370,7 @@ static NTSTATUS find_file_in_dir( char *unix_name, int pos, const WCHAR *name, i
     DIR *dir;
     struct dirent *de;
     struct stat st;
+    NTSTATUS status;
     int ret, used_default;
 
     /* try a shortcut for this directory */
@@ -2183,6 +2465,17 @@ static NTSTATUS find_file_in_dir( char *unix_name, int pos, const WCHAR *name, i
     }
 #endif /* VFAT_IOCTL_READDIR_BOTH */
 
+    /* look for the long name in the directory index; hashed short names always contain a '~',
+     * so other names don't require a scan of the directory if they are not in the index */
+
+    if ((status = find_dir_index_name( unix_name, name, length, unix_name + pos )) == STATUS_SUCCESS)
+    {
+        unix_name[pos - 1] = '/';
+        goto success;
+    }
+    if (status == STATUS_OBJECT_PATH_NOT_FOUND && (!is_name_8_dot_3 || !memchrW( name, '~', length )))
+        goto not_found;
+
     if (!(dir = opendir( unix_name )))
     {
         if (errno == ENOENT) return STATUS_OBJECT_PATH_NOT_FOUND;
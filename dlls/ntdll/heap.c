@@ -83,6 +83,7 @@ typedef struct
 /* Value for arena 'magic' field */
 #define ARENA_INUSE_MAGIC      0x455355
 #define ARENA_PENDING_MAGIC    0xbedead
+#define ARENA_LFH_MAGIC        0x48464c    /* block cached by the low fragmentation heap, contents undefined */
 #define ARENA_FREE_MAGIC       0x45455246
 #define ARENA_LARGE_MAGIC      0x6752614c
 
@@ -120,6 +121,12 @@ static const SIZE_T HEAP_freeListSizes[] =
 };
 #define HEAP_NB_FREE_LISTS  (sizeof(HEAP_freeListSizes)/sizeof(HEAP_freeListSizes[0]))
 
+/* Low fragmentation heap: freed blocks smaller than this size are kept in lock-free per-size caches */
+#define HEAP_LFH_MAX_BLOCK_SIZE  0x4000
+#define HEAP_LFH_NB_CACHES       (HEAP_LFH_MAX_BLOCK_SIZE / ALIGNMENT)
+#define HEAP_LFH_MAX_DEPTH       256  /* max number of blocks kept in each cache */
+#define HEAP_LFH_MAX_CACHED      0x100000  /* max total size of the blocks kept in all caches */
+
 typedef union
 {
     ARENA_FREE  arena;
@@ -158,6 +165,8 @@ typedef struct tagHEAP
     ARENA_INUSE    **pending_free;  /* Ring buffer for pending free requests */
     RTL_CRITICAL_SECTION critSection; /* Critical section for serialization */
     FREE_LIST_ENTRY *freeList;      /* Free lists */
+    SLIST_HEADER    *lfh_cache;     /* Low fragmentation heap block caches, one per block size */
+    LONG             lfh_cached;    /* Total size of the blocks in the low fragmentation heap caches */
 } HEAP;
 
 #define HEAP_MAGIC       ((DWORD)('H' | ('E'<<8) | ('A'<<16) | ('P'<<24)))
@@ -290,7 +299,8 @@ static void subheap_notify_free_all(SUBHEAP const *subheap)
         {
             ARENA_INUSE const *pArena = (ARENA_INUSE const *)ptr;
             if (pArena->magic == ARENA_INUSE_MAGIC) notify_free(pArena + 1);
-            else if (pArena->magic != ARENA_PENDING_MAGIC) ERR("bad inuse_magic @%p\n", pArena);
+            else if (pArena->magic != ARENA_PENDING_MAGIC && pArena->magic != ARENA_LFH_MAGIC)
+                ERR("bad inuse_magic @%p\n", pArena);
             ptr += sizeof(*pArena) + (pArena->size & ARENA_SIZE_MASK);
         }
     }
@@ -377,7 +387,8 @@ static void HEAP_Dump( HEAP *heap )
             {
                 ARENA_INUSE *pArena = (ARENA_INUSE *)ptr;
                 DPRINTF( "%p %08x %s %08x\n",
-                         pArena, pArena->magic, pArena->magic == ARENA_INUSE_MAGIC ? "used" : "pend",
+                         pArena, pArena->magic, pArena->magic == ARENA_INUSE_MAGIC ? "used" :
+                         (pArena->magic == ARENA_LFH_MAGIC ? "lfh " : "pend"),
                          pArena->size & ARENA_SIZE_MASK );
                 ptr += sizeof(*pArena) + (pArena->size & ARENA_SIZE_MASK);
                 arenaSize += sizeof(ARENA_INUSE);
@@ -660,8 +671,11 @@ static void HEAP_MakeInUseBlockFree( SUBHEAP *subheap, ARENA_INUSE *pArena )
 
     /* Free the whole sub-heap if it's empty and not the original one */
 
+    /* With the low fragmentation heap, sub-heaps are looked up without holding
+     * the heap lock, so they have to remain valid until the heap is destroyed. */
+
     if (((char *)pFree == (char *)subheap->base + subheap->headerSize) &&
-        (subheap != &subheap->heap->subheap))
+        (subheap != &subheap->heap->subheap) && !subheap->heap->lfh_cache)
     {
         void *addr = subheap->base;
 
@@ -905,7 +919,12 @@ static SUBHEAP *HEAP_CreateSubHeap( HEAP *heap, LPVOID address, DWORD flags,
         subheap->commitSize = commitSize;
         subheap->magic      = SUBHEAP_MAGIC;
         subheap->headerSize = ROUND_SIZE( sizeof(SUBHEAP) );
-        list_add_head( &heap->subheap_list, &subheap->entry );
+        /* the low fragmentation heap walks the sub-heap list without holding the
+         * heap lock, so the entry must be complete before it becomes visible */
+        subheap->entry.next = heap->subheap_list.next;
+        subheap->entry.prev = &heap->subheap_list;
+        heap->subheap_list.next->prev = &subheap->entry;
+        interlocked_xchg_ptr( (void **)&heap->subheap_list.next, &subheap->entry );
     }
     else
     {
@@ -1204,7 +1223,8 @@ static BOOL HEAP_ValidateInUseArena( const SUBHEAP *subheap, const ARENA_INUSE *
     }
 
     /* Check magic number */
-    if (pArena->magic != ARENA_INUSE_MAGIC && pArena->magic != ARENA_PENDING_MAGIC)
+    if (pArena->magic != ARENA_INUSE_MAGIC && pArena->magic != ARENA_PENDING_MAGIC &&
+        pArena->magic != ARENA_LFH_MAGIC)
     {
         if (quiet == NOISY) {
             ERR("Heap %p: invalid in-use arena magic %08x for %p\n", subheap->heap, pArena->magic, pArena );
@@ -1291,7 +1311,7 @@ static BOOL HEAP_ValidateInUseArena( const SUBHEAP *subheap, const ARENA_INUSE *
             ptr++;
         }
     }
-    else if (flags & HEAP_TAIL_CHECKING_ENABLED)
+    else if (pArena->magic != ARENA_LFH_MAGIC && (flags & HEAP_TAIL_CHECKING_ENABLED))
     {
         const unsigned char *data = (const unsigned char *)(pArena + 1) + size - pArena->unused_bytes;
 
@@ -1419,7 +1439,7 @@ static BOOL validate_block_pointer( HEAP *heap, SUBHEAP **ret_subheap, const ARE
         ret = HEAP_ValidateInUseArena( subheap, arena, QUIET );
     else if ((ULONG_PTR)arena % ALIGNMENT != ARENA_OFFSET)
         WARN( "Heap %p: unaligned arena pointer %p\n", subheap->heap, arena );
-    else if (arena->magic == ARENA_PENDING_MAGIC)
+    else if (arena->magic == ARENA_PENDING_MAGIC || arena->magic == ARENA_LFH_MAGIC)
         WARN( "Heap %p: block %p used after free\n", subheap->heap, arena + 1 );
     else if (arena->magic != ARENA_INUSE_MAGIC)
         WARN( "Heap %p: invalid in-use arena magic %08x for %p\n", subheap->heap, arena->magic, arena );
@@ -1437,6 +1457,70 @@ static BOOL validate_block_pointer( HEAP *heap, SUBHEAP **ret_subheap, const ARE
 }
 
 
+/***********************************************************************
+ *           lfh_alloc_block
+ *
+ * Get a block of the specified size from the low fragmentation heap caches.
+ * Doesn't require the heap lock.
+ */
+static ARENA_INUSE *lfh_alloc_block( HEAP *heap, SIZE_T size )
+{
+    SLIST_ENTRY *entry;
+    ARENA_INUSE *arena;
+
+    if (!(entry = RtlInterlockedPopEntrySList( &heap->lfh_cache[size / ALIGNMENT] ))) return NULL;
+    arena = (ARENA_INUSE *)entry - 1;
+    interlocked_xchg_add( &heap->lfh_cached, -(LONG)(arena->size & ARENA_SIZE_MASK) );
+    arena->magic = ARENA_INUSE_MAGIC;
+    return arena;
+}
+
+
+/***********************************************************************
+ *           lfh_free_block
+ *
+ * Put a small block into the low fragmentation heap caches instead of freeing it.
+ * Doesn't require the heap lock; returns FALSE if the block has to go through
+ * the normal free path instead.
+ */
+static BOOL lfh_free_block( HEAP *heap, ARENA_INUSE *arena )
+{
+    SLIST_HEADER *cache;
+    SUBHEAP *subheap;
+    ARENA_INUSE old, new;
+    SIZE_T size;
+
+    if (!(subheap = HEAP_FindSubHeap( heap, arena ))) return FALSE;
+    if ((const char *)arena < (char *)subheap->base + subheap->headerSize) return FALSE;
+    if ((ULONG_PTR)arena % ALIGNMENT != ARENA_OFFSET) return FALSE;
+
+    old = *arena;
+    if (old.magic != ARENA_INUSE_MAGIC || (old.size & ARENA_FLAG_FREE)) return FALSE;
+    if ((size = old.size & ARENA_SIZE_MASK) >= HEAP_LFH_MAX_BLOCK_SIZE) return FALSE;
+    cache = &heap->lfh_cache[size / ALIGNMENT];
+    if (RtlQueryDepthSList( cache ) >= HEAP_LFH_MAX_DEPTH) return FALSE;
+
+    /* blocks beyond the total limit go back to the free lists, where they can be coalesced */
+    if (interlocked_xchg_add( &heap->lfh_cached, size ) + size > HEAP_LFH_MAX_CACHED)
+    {
+        interlocked_xchg_add( &heap->lfh_cached, -(LONG)size );
+        return FALSE;
+    }
+
+    /* mark the block as cached, this also catches concurrent double frees */
+    new = old;
+    new.magic = ARENA_LFH_MAGIC;
+    if (interlocked_cmpxchg( (int *)arena + 1, ((int *)&new)[1], ((int *)&old)[1] ) != ((int *)&old)[1])
+    {
+        interlocked_xchg_add( &heap->lfh_cached, -(LONG)size );
+        return FALSE;
+    }
+
+    RtlInterlockedPushEntrySList( cache, (SLIST_ENTRY *)(arena + 1) );
+    return TRUE;
+}
+
+
 /***********************************************************************
  *           heap_set_debug_flags
  */
@@ -1492,7 +1576,7 @@ void heap_set_debug_flags( HANDLE handle )
                 {
                     if (arena->magic == ARENA_PENDING_MAGIC)
                         mark_block_free( arena + 1, size, flags );
-                    else
+                    else if (arena->magic != ARENA_LFH_MAGIC)
                         mark_block_tail( (char *)(arena + 1) + size - arena->unused_bytes,
                                          arena->unused_bytes, flags );
                     ptr += sizeof(ARENA_INUSE) + size;
@@ -1628,6 +1712,12 @@ HANDLE WINAPI RtlDestroyHeap( HANDLE heap )
         addr = heapPtr->pending_free;
         NtFreeVirtualMemory( NtCurrentProcess(), &addr, &size, MEM_RELEASE );
     }
+    if (heapPtr->lfh_cache)
+    {
+        size = 0;
+        addr = heapPtr->lfh_cache;
+        NtFreeVirtualMemory( NtCurrentProcess(), &addr, &size, MEM_RELEASE );
+    }
     size = 0;
     addr = heapPtr->subheap.base;
     NtFreeVirtualMemory( NtCurrentProcess(), &addr, &size, MEM_RELEASE );
@@ -1673,6 +1763,16 @@ PVOID WINAPI RtlAllocateHeap( HANDLE heap, ULONG flags, SIZE_T size )
     }
     if (rounded_size < HEAP_MIN_DATA_SIZE) rounded_size = HEAP_MIN_DATA_SIZE;
 
+    if (heapPtr->lfh_cache && rounded_size < HEAP_LFH_MAX_BLOCK_SIZE &&
+        (pInUse = lfh_alloc_block( heapPtr, rounded_size )))
+    {
+        pInUse->unused_bytes = (pInUse->size & ARENA_SIZE_MASK) - size;
+        notify_alloc( pInUse + 1, size, flags & HEAP_ZERO_MEMORY );
+        initialize_block( pInUse + 1, size, pInUse->unused_bytes, flags );
+        TRACE("(%p,%08x,%08lx): returning %p\n", heap, flags, size, pInUse + 1 );
+        return pInUse + 1;
+    }
+
     if (!(flags & HEAP_NO_SERIALIZE)) RtlEnterCriticalSection( &heapPtr->critSection );
 
     if (rounded_size >= HEAP_MIN_LARGE_BLOCK_SIZE && (flags & HEAP_GROWABLE))
@@ -1756,13 +1856,21 @@ BOOLEAN WINAPI RtlFreeHeap( HANDLE heap, ULONG flags, PVOID ptr )
 
     flags &= HEAP_NO_SERIALIZE;
     flags |= heapPtr->flags;
+    pInUse  = (ARENA_INUSE *)ptr - 1;
+
+    if (heapPtr->lfh_cache && lfh_free_block( heapPtr, pInUse ))
+    {
+        notify_free( ptr );
+        TRACE("(%p,%08x,%p): returning TRUE\n", heap, flags, ptr );
+        return TRUE;
+    }
+
     if (!(flags & HEAP_NO_SERIALIZE)) RtlEnterCriticalSection( &heapPtr->critSection );
 
     /* Inform valgrind we are trying to free memory, so it can throw up an error message */
     notify_free( ptr );
 
     /* Some sanity checks */
-    pInUse  = (ARENA_INUSE *)ptr - 1;
     if (!validate_block_pointer( heapPtr, &subheap, pInUse )) goto error;
 
     if (!subheap)
@@ -2123,7 +2231,8 @@ NTSTATUS WINAPI RtlWalkHeap( HANDLE heap, PVOID entry_ptr )
         }
 
         if (((ARENA_INUSE *)ptr - 1)->magic == ARENA_INUSE_MAGIC ||
-            ((ARENA_INUSE *)ptr - 1)->magic == ARENA_PENDING_MAGIC)
+            ((ARENA_INUSE *)ptr - 1)->magic == ARENA_PENDING_MAGIC ||
+            ((ARENA_INUSE *)ptr - 1)->magic == ARENA_LFH_MAGIC)
         {
             ARENA_INUSE *pArena = (ARENA_INUSE *)ptr - 1;
             ptr += pArena->size & ARENA_SIZE_MASK;
@@ -2171,7 +2280,7 @@ NTSTATUS WINAPI RtlWalkHeap( HANDLE heap, PVOID entry_ptr )
         entry->lpData = pArena + 1;
         entry->cbData = pArena->size & ARENA_SIZE_MASK;
         entry->cbOverhead = sizeof(ARENA_INUSE);
-        entry->wFlags = (pArena->magic == ARENA_PENDING_MAGIC) ?
+        entry->wFlags = (pArena->magic == ARENA_PENDING_MAGIC || pArena->magic == ARENA_LFH_MAGIC) ?
                         PROCESS_HEAP_UNCOMMITTED_RANGE : PROCESS_HEAP_ENTRY_BUSY;
         /* FIXME: can't handle PROCESS_HEAP_ENTRY_MOVEABLE
         and PROCESS_HEAP_ENTRY_DDESHARE yet */
@@ -2236,6 +2345,8 @@ ULONG WINAPI RtlGetProcessHeaps( ULONG count, HANDLE *heaps )
 NTSTATUS WINAPI RtlQueryHeapInformation( HANDLE heap, HEAP_INFORMATION_CLASS info_class,
                                          PVOID info, SIZE_T size_in, PSIZE_T size_out)
 {
+    HEAP *heapPtr;
+
     switch (info_class)
     {
     case HeapCompatibilityInformation:
@@ -2244,7 +2355,8 @@ NTSTATUS WINAPI RtlQueryHeapInformation( HANDLE heap, HEAP_INFORMATION_CLASS inf
         if (size_in < sizeof(ULONG))
             return STATUS_BUFFER_TOO_SMALL;
 
-        *(ULONG *)info = 0; /* standard heap */
+        heapPtr = HEAP_GetPtr( heap );
+        *(ULONG *)info = (heapPtr && heapPtr->lfh_cache) ? 2 : 0; /* low fragmentation or standard heap */
         return STATUS_SUCCESS;
 
     default:
@@ -2258,6 +2370,42 @@ NTSTATUS WINAPI RtlQueryHeapInformation( HANDLE heap, HEAP_INFORMATION_CLASS inf
  */
 NTSTATUS WINAPI RtlSetHeapInformation( HANDLE heap, HEAP_INFORMATION_CLASS info_class, PVOID info, SIZE_T size)
 {
-    FIXME("%p %d %p %ld stub\n", heap, info_class, info, size);
-    return STATUS_SUCCESS;
+    HEAP *heapPtr;
+    NTSTATUS status = STATUS_SUCCESS;
+
+    switch (info_class)
+    {
+    case HeapCompatibilityInformation:
+        if (size < sizeof(ULONG)) return STATUS_BUFFER_TOO_SMALL;
+        if (!(heapPtr = HEAP_GetPtr( heap ))) return STATUS_INVALID_HANDLE;
+
+        TRACE( "%p: setting compatibility information %u\n", heap, *(ULONG *)info );
+
+        if (*(ULONG *)info == 0)  /* the low fragmentation heap can't be disabled */
+            return heapPtr->lfh_cache ? STATUS_UNSUCCESSFUL : STATUS_SUCCESS;
+        if (*(ULONG *)info != 2) return STATUS_UNSUCCESSFUL;
+
+        /* the low fragmentation heap requires serialization and doesn't support debugging */
+        if ((heapPtr->flags & (HEAP_NO_SERIALIZE | HEAP_VALIDATE | HEAP_TAIL_CHECKING_ENABLED |
+                               HEAP_FREE_CHECKING_ENABLED | HEAP_PAGE_ALLOCS)) ||
+            heapPtr->pending_free || RUNNING_ON_VALGRIND)
+            return STATUS_UNSUCCESSFUL;
+
+        RtlEnterCriticalSection( &heapPtr->critSection );
+        if (!heapPtr->lfh_cache)
+        {
+            void *ptr = NULL;
+            SIZE_T cache_size = HEAP_LFH_NB_CACHES * sizeof(*heapPtr->lfh_cache);
+
+            if (!(status = NtAllocateVirtualMemory( NtCurrentProcess(), &ptr, 0, &cache_size,
+                                                    MEM_COMMIT, PAGE_READWRITE )))
+                heapPtr->lfh_cache = ptr;
+        }
+        RtlLeaveCriticalSection( &heapPtr->critSection );
+        return status;
+
+    default:
+        FIXME("%p %d %p %ld stub\n", heap, info_class, info, size);
+        return STATUS_SUCCESS;
+    }
 }
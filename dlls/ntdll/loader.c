@@ -82,10 +82,24 @@ static const WCHAR dllW[] = {'.','d','l','l',0};
 typedef struct _wine_modref
 {
     LDR_MODULE            ldr;
+    LIST_ENTRY            hash_entry;  /* entry in the base name hash table */
     int                   nDeps;
     struct _wine_modref **deps;
 } WINE_MODREF;
 
+/* modules hashed by base name, in load order within each bucket */
+#define MODULE_HASH_SIZE 64
+static LIST_ENTRY module_hash_table[MODULE_HASH_SIZE];
+
+/* cache of resolved forwarded exports, indexed by forward string address */
+#define FORWARD_CACHE_SIZE 512
+struct forward_entry
+{
+    const char *forward;
+    FARPROC     proc;
+};
+static struct forward_entry *forward_cache;
+
 /* info about the current builtin dll load */
 /* used to keep track of things across the register_dll constructor call */
 struct builtin_load_info
@@ -360,6 +374,42 @@ static WINE_MODREF *get_modref( HMODULE hmod )
 }
 
 
+/**********************************************************************
+ *	    hash_module_name
+ *
+ * Case-insensitive hash of the base name part of a module name.
+ */
+static LIST_ENTRY *hash_module_name( LPCWSTR name )
+{
+    const WCHAR *p;
+    unsigned int hash = 0;
+
+    if ((p = strrchrW( name, '\\' ))) name = p + 1;
+    for (p = name; *p; p++) hash = hash * 31 + tolowerW( *p );
+    return &module_hash_table[hash % MODULE_HASH_SIZE];
+}
+
+
+/**********************************************************************
+ *	    add_module_hash
+ *
+ * Insert a module in the base name hash table.
+ * The loader_section must be locked while calling this function.
+ */
+static void add_module_hash( WINE_MODREF *wm, BOOL head )
+{
+    LIST_ENTRY *bucket = hash_module_name( wm->ldr.BaseDllName.Buffer );
+
+    if (!bucket->Flink)
+    {
+        unsigned int i;
+        for (i = 0; i < MODULE_HASH_SIZE; i++) InitializeListHead( &module_hash_table[i] );
+    }
+    if (head) InsertHeadList( bucket, &wm->hash_entry );
+    else InsertTailList( bucket, &wm->hash_entry );
+}
+
+
 /**********************************************************************
  *	    find_basename_module
  *
@@ -373,13 +423,14 @@ static WINE_MODREF *find_basename_module( LPCWSTR name )
     if (cached_modref && !strcmpiW( name, cached_modref->ldr.BaseDllName.Buffer ))
         return cached_modref;
 
-    mark = &NtCurrentTeb()->Peb->LdrData->InLoadOrderModuleList;
+    mark = hash_module_name( name );
+    if (!mark->Flink) return NULL;
     for (entry = mark->Flink; entry != mark; entry = entry->Flink)
     {
-        LDR_MODULE *mod = CONTAINING_RECORD(entry, LDR_MODULE, InLoadOrderModuleList);
-        if (!strcmpiW( name, mod->BaseDllName.Buffer ))
+        WINE_MODREF *wm = CONTAINING_RECORD(entry, WINE_MODREF, hash_entry);
+        if (!strcmpiW( name, wm->ldr.BaseDllName.Buffer ))
         {
-            cached_modref = CONTAINING_RECORD(mod, WINE_MODREF, ldr);
+            cached_modref = wm;
             return cached_modref;
         }
     }
@@ -400,13 +451,14 @@ static WINE_MODREF *find_fullname_module( LPCWSTR name )
     if (cached_modref && !strcmpiW( name, cached_modref->ldr.FullDllName.Buffer ))
         return cached_modref;
 
-    mark = &NtCurrentTeb()->Peb->LdrData->InLoadOrderModuleList;
+    mark = hash_module_name( name );
+    if (!mark->Flink) return NULL;
     for (entry = mark->Flink; entry != mark; entry = entry->Flink)
     {
-        LDR_MODULE *mod = CONTAINING_RECORD(entry, LDR_MODULE, InLoadOrderModuleList);
-        if (!strcmpiW( name, mod->FullDllName.Buffer ))
+        WINE_MODREF *wm = CONTAINING_RECORD(entry, WINE_MODREF, hash_entry);
+        if (!strcmpiW( name, wm->ldr.FullDllName.Buffer ))
         {
-            cached_modref = CONTAINING_RECORD(mod, WINE_MODREF, ldr);
+            cached_modref = wm;
             return cached_modref;
         }
     }
@@ -427,8 +479,24 @@ static FARPROC find_forwarded_export( HMODULE module, const char *forward, LPCWS
     WINE_MODREF *wm;
     WCHAR mod_name[32];
     const char *end = strrchr(forward, '.');
+    struct forward_entry *cache_entry = NULL;
     FARPROC proc = NULL;
 
+    /* relay and snoop thunks depend on the importing module, don't cache them */
+    if (!TRACE_ON(relay) && !TRACE_ON(snoop))
+    {
+        ULONG_PTR key = (ULONG_PTR)forward;
+
+        if (!forward_cache)
+            forward_cache = RtlAllocateHeap( GetProcessHeap(), HEAP_ZERO_MEMORY,
+                                             FORWARD_CACHE_SIZE * sizeof(*forward_cache) );
+        if (forward_cache)
+        {
+            cache_entry = &forward_cache[(key ^ (key >> 9)) % FORWARD_CACHE_SIZE];
+            if (cache_entry->forward == forward) return cache_entry->proc;
+        }
+    }
+
     if (!end) return NULL;
     if ((end - forward) * sizeof(WCHAR) >= sizeof(mod_name)) return NULL;
     ascii_to_unicode( mod_name, forward, end - forward );
@@ -476,6 +544,11 @@ static FARPROC find_forwarded_export( HMODULE module, const char *forward, LPCWS
             forward, debugstr_w(get_modref(module)->ldr.FullDllName.Buffer),
             debugstr_w(get_modref(module)->ldr.BaseDllName.Buffer) );
     }
+    else if (cache_entry)
+    {
+        cache_entry->forward = forward;
+        cache_entry->proc = proc;
+    }
     return proc;
 }
 
@@ -882,6 +955,9 @@ static NTSTATUS fixup_imports( WINE_MODREF *wm, LPCWSTR load_path )
     DWORD size;
     NTSTATUS status;
     ULONG_PTR cookie;
+    LARGE_INTEGER start, end, freq;
+    LONGLONG prev_nested = 0;
+    static LONGLONG nested_time;  /* time spent resolving the imports of dependencies */
 
     if (!(wm->ldr.Flags & LDR_DONT_RESOLVE_REFS)) return STATUS_SUCCESS;  /* already done */
     wm->ldr.Flags &= ~LDR_DONT_RESOLVE_REFS;
@@ -910,6 +986,12 @@ static NTSTATUS fixup_imports( WINE_MODREF *wm, LPCWSTR load_path )
     prev = current_modref;
     current_modref = wm;
     status = STATUS_SUCCESS;
+    if (TRACE_ON(imports))
+    {
+        prev_nested = nested_time;
+        nested_time = 0;
+        NtQueryPerformanceCounter( &start, NULL );
+    }
     for (i = 0; i < nb_imports; i++)
     {
         if (!import_dll( wm->ldr.BaseAddress, &imports[i], load_path, &wm->deps[i] ))
@@ -918,6 +1000,18 @@ static NTSTATUS fixup_imports( WINE_MODREF *wm, LPCWSTR load_path )
             status = STATUS_DLL_NOT_FOUND;
         }
     }
+    if (TRACE_ON(imports))
+    {
+        LONGLONG total;
+
+        NtQueryPerformanceCounter( &end, &freq );
+        total = end.QuadPart - start.QuadPart;
+        TRACE_(imports)( "resolved imports of %s in %u us (%u us in dependencies)\n",
+                         debugstr_w(wm->ldr.BaseDllName.Buffer),
+                         (UINT)(total * 1000000 / freq.QuadPart),
+                         (UINT)(nested_time * 1000000 / freq.QuadPart) );
+        nested_time = prev_nested + total;
+    }
     current_modref = prev;
     if (wm->ldr.ActivationContext) RtlDeactivateActivationContext( 0, cookie );
     return status;
@@ -969,6 +1063,7 @@ static WINE_MODREF *alloc_module( HMODULE hModule, LPCWSTR filename )
                    &wm->ldr.InLoadOrderModuleList);
     InsertTailList(&NtCurrentTeb()->Peb->LdrData->InMemoryOrderModuleList,
                    &wm->ldr.InMemoryOrderModuleList);
+    add_module_hash( wm, FALSE );
 
     /* wait until init is called for inserting into this list */
     wm->ldr.InInitializationOrderModuleList.Flink = NULL;
@@ -1609,6 +1704,7 @@ static void load_builtin_callback( void *module, const char *filename )
             /* the module has only be inserted in the load & memory order lists */
             RemoveEntryList(&wm->ldr.InLoadOrderModuleList);
             RemoveEntryList(&wm->ldr.InMemoryOrderModuleList);
+            RemoveEntryList(&wm->hash_entry);
             /* FIXME: free the modref */
             builtin_load_info->status = STATUS_DLL_NOT_FOUND;
             return;
@@ -1823,6 +1919,7 @@ static NTSTATUS load_native_dll( LPCWSTR load_path, LPCWSTR name, HANDLE file,
             /* the module has only be inserted in the load & memory order lists */
             RemoveEntryList(&wm->ldr.InLoadOrderModuleList);
             RemoveEntryList(&wm->ldr.InMemoryOrderModuleList);
+            RemoveEntryList(&wm->hash_entry);
 
             /* FIXME: there are several more dangling references
              * left. Including dlls loaded by this dll before the
@@ -2801,6 +2898,7 @@ static void free_modref( WINE_MODREF *wm )
 {
     RemoveEntryList(&wm->ldr.InLoadOrderModuleList);
     RemoveEntryList(&wm->ldr.InMemoryOrderModuleList);
+    RemoveEntryList(&wm->hash_entry);
     if (wm->ldr.InInitializationOrderModuleList.Flink)
         RemoveEntryList(&wm->ldr.InInitializationOrderModuleList);
 
@@ -2822,6 +2920,8 @@ static void free_modref( WINE_MODREF *wm )
     if (wm->ldr.Flags & LDR_WINE_INTERNAL) wine_dll_unload( wm->ldr.SectionHandle );
     NtUnmapViewOfSection( NtCurrentProcess(), wm->ldr.BaseAddress );
     if (cached_modref == wm) cached_modref = NULL;
+    /* forwards may resolve to this module, or be stored in it */
+    if (forward_cache) memset( forward_cache, 0, FORWARD_CACHE_SIZE * sizeof(*forward_cache) );
     RtlFreeUnicodeString( &wm->ldr.FullDllName );
     RtlFreeHeap( GetProcessHeap(), 0, wm->deps );
     RtlFreeHeap( GetProcessHeap(), 0, wm );
@@ -3086,6 +3186,8 @@ void WINAPI LdrInitializeThunk( void *kernel_start, ULONG_PTR unknown2,
     InsertHeadList( &peb->LdrData->InLoadOrderModuleList, &wm->ldr.InLoadOrderModuleList );
     RemoveEntryList( &wm->ldr.InMemoryOrderModuleList );
     InsertHeadList( &peb->LdrData->InMemoryOrderModuleList, &wm->ldr.InMemoryOrderModuleList );
+    RemoveEntryList( &wm->hash_entry );
+    add_module_hash( wm, TRUE );
 
     if ((status = virtual_alloc_thread_stack( NtCurrentTeb(), 0, 0 )) != STATUS_SUCCESS) goto error;
     if ((status = server_init_process_done()) != STATUS_SUCCESS) goto error;
@@ -26,6 +26,7 @@
 
 #include <assert.h>
 #include <errno.h>
+#include <limits.h>
 #include <signal.h>
 #ifdef HAVE_SYS_TIME_H
 # include <sys/time.h>
@@ -42,6 +43,9 @@
 #ifdef HAVE_SCHED_H
 # include <sched.h>
 #endif
+#ifdef HAVE_SYS_SYSCALL_H
+# include <sys/syscall.h>
+#endif
 #include <string.h>
 #include <stdarg.h>
 #include <stdio.h>
@@ -72,6 +76,371 @@ static inline int interlocked_dec_if_nonzero( int *dest )
     return val;
 }
 
+#ifdef __linux__
+
+#define TICKSPERSEC 10000000
+
+static int wait_op = 128; /*FUTEX_WAIT|FUTEX_PRIVATE_FLAG*/
+static int wake_op = 129; /*FUTEX_WAKE|FUTEX_PRIVATE_FLAG*/
+
+static inline int futex_wait( int *addr, int val, struct timespec *timeout )
+{
+    return syscall( __NR_futex, addr, wait_op, val, timeout, 0, 0 );
+}
+
+static inline int futex_wake( int *addr, int val )
+{
+    return syscall( __NR_futex, addr, wake_op, val, NULL, 0, 0 );
+}
+
+static inline int use_futexes(void)
+{
+    static int supported = -1;
+
+    if (supported == -1)
+    {
+        futex_wait( &supported, 10, NULL );
+        if (errno == ENOSYS)
+        {
+            wait_op = 0; /*FUTEX_WAIT*/
+            wake_op = 1; /*FUTEX_WAKE*/
+            futex_wait( &supported, 10, NULL );
+        }
+        supported = (errno != ENOSYS);
+    }
+    return supported;
+}
+
+/* convert an NT timeout (absolute or relative) to a relative timespec */
+static void timespec_from_timeout( struct timespec *timespec, const LARGE_INTEGER *timeout )
+{
+    LARGE_INTEGER now;
+    LONGLONG diff = timeout->QuadPart;
+
+    if (diff >= 0)  /* absolute time */
+    {
+        NtQuerySystemTime( &now );
+        diff -= now.QuadPart;
+        if (diff < 0) diff = 0;
+    }
+    else diff = -diff;
+
+    timespec->tv_sec  = diff / TICKSPERSEC;
+    timespec->tv_nsec = (diff % TICKSPERSEC) * 100;
+}
+
+/* With futexes the condition variable value is a wake-up sequence number instead
+ * of a waiter count, sleeping threads wait for it to change. */
+static inline NTSTATUS fast_wait_cv( RTL_CONDITION_VARIABLE *variable, int val, const LARGE_INTEGER *timeout )
+{
+    struct timespec timespec;
+    int ret;
+
+    if (timeout && timeout->QuadPart != TIMEOUT_INFINITE)
+    {
+        timespec_from_timeout( &timespec, timeout );
+        ret = futex_wait( (int *)&variable->Ptr, val, &timespec );
+    }
+    else
+        ret = futex_wait( (int *)&variable->Ptr, val, NULL );
+
+    if (ret == -1 && errno == ETIMEDOUT)
+        return STATUS_TIMEOUT;
+    return STATUS_WAIT_0;
+}
+
+static inline NTSTATUS fast_sleep_cs_cv( RTL_CONDITION_VARIABLE *variable,
+                                         RTL_CRITICAL_SECTION *crit, const LARGE_INTEGER *timeout )
+{
+    NTSTATUS status;
+    int val;
+
+    if (!use_futexes()) return STATUS_NOT_IMPLEMENTED;
+
+    val = *(int *)&variable->Ptr;
+    RtlLeaveCriticalSection( crit );
+    status = fast_wait_cv( variable, val, timeout );
+    RtlEnterCriticalSection( crit );
+    return status;
+}
+
+static inline NTSTATUS fast_sleep_srw_cv( RTL_CONDITION_VARIABLE *variable,
+                                          RTL_SRWLOCK *lock, const LARGE_INTEGER *timeout, ULONG flags )
+{
+    NTSTATUS status;
+    int val;
+
+    if (!use_futexes()) return STATUS_NOT_IMPLEMENTED;
+
+    val = *(int *)&variable->Ptr;
+
+    if (flags & RTL_CONDITION_VARIABLE_LOCKMODE_SHARED)
+        RtlReleaseSRWLockShared( lock );
+    else
+        RtlReleaseSRWLockExclusive( lock );
+
+    status = fast_wait_cv( variable, val, timeout );
+
+    if (flags & RTL_CONDITION_VARIABLE_LOCKMODE_SHARED)
+        RtlAcquireSRWLockShared( lock );
+    else
+        RtlAcquireSRWLockExclusive( lock );
+    return status;
+}
+
+static inline NTSTATUS fast_wake_cv( RTL_CONDITION_VARIABLE *variable, int count )
+{
+    if (!use_futexes()) return STATUS_NOT_IMPLEMENTED;
+
+    interlocked_xchg_add( (int *)&variable->Ptr, 1 );
+    futex_wake( (int *)&variable->Ptr, count );
+    return STATUS_SUCCESS;
+}
+
+#else
+
+static inline NTSTATUS fast_sleep_cs_cv( RTL_CONDITION_VARIABLE *variable,
+                                         RTL_CRITICAL_SECTION *crit, const LARGE_INTEGER *timeout )
+{
+    return STATUS_NOT_IMPLEMENTED;
+}
+
+static inline NTSTATUS fast_sleep_srw_cv( RTL_CONDITION_VARIABLE *variable,
+                                          RTL_SRWLOCK *lock, const LARGE_INTEGER *timeout, ULONG flags )
+{
+    return STATUS_NOT_IMPLEMENTED;
+}
+
+static inline NTSTATUS fast_wake_cv( RTL_CONDITION_VARIABLE *variable, int count )
+{
+    return STATUS_NOT_IMPLEMENTED;
+}
+
+#endif
+
+/* events and semaphores whose state is shared with the server, see get_fast_sync_shm
+ *
+ * The server remains the owner of the objects and blocks the waiting threads,
+ * but acquiring a signaled object and changing the state of an object nobody
+ * waits for in the server is done here with atomic operations. */
+
+#define FAST_SYNC_WAIT    1  /* handle can be waited on */
+#define FAST_SYNC_MODIFY  2  /* handle can change the state */
+
+union fast_sync_cache_entry
+{
+    LONG64 data;
+    struct
+    {
+        unsigned int index : 24;  /* index of the shared state + 1 */
+        unsigned int access : 8;  /* FAST_SYNC_* access of the handle */
+        unsigned int id;          /* id of the object using the shared state */
+    } s;
+};
+
+C_ASSERT( sizeof(union fast_sync_cache_entry) == sizeof(LONG64) );
+
+#define FAST_SYNC_CACHE_BLOCK_SIZE  (65536 / sizeof(union fast_sync_cache_entry))
+#define FAST_SYNC_CACHE_ENTRIES     128
+
+static union fast_sync_cache_entry *fast_sync_cache[FAST_SYNC_CACHE_ENTRIES];
+static volatile fast_sync_shm_t *fast_sync_shm;
+
+static inline void set_fast_sync_cache_entry( union fast_sync_cache_entry *cache, LONG64 data )
+{
+    LONG64 tmp = cache->data;
+    while (interlocked_cmpxchg64( &cache->data, data, tmp ) != tmp) tmp = cache->data;
+}
+
+static inline unsigned int fast_sync_handle_to_index( HANDLE handle, unsigned int *entry )
+{
+    unsigned int idx = (wine_server_obj_handle(handle) >> 2) - 1;
+    *entry = idx / FAST_SYNC_CACHE_BLOCK_SIZE;
+    return idx % FAST_SYNC_CACHE_BLOCK_SIZE;
+}
+
+/* map the shared state if enabled with WINEFASTSYNC, returns whether it's available */
+static BOOL init_fast_sync(void)
+{
+    static int enabled = -1;
+    HANDLE mapping = 0;
+    void *ptr = NULL;
+    SIZE_T size = 0;
+
+    if (enabled == -1)
+    {
+        const char *env = getenv( "WINEFASTSYNC" );
+        enabled = env && atoi( env );
+    }
+    if (!enabled) return FALSE;
+    if (fast_sync_shm) return TRUE;
+
+    SERVER_START_REQ( get_fast_sync_shm )
+    {
+        if (!wine_server_call( req )) mapping = wine_server_ptr_handle( reply->handle );
+    }
+    SERVER_END_REQ;
+    if (!mapping)
+    {
+        enabled = 0;
+        return FALSE;
+    }
+    if (NtMapViewOfSection( mapping, NtCurrentProcess(), &ptr, 0, 0, NULL, &size,
+                            ViewShare, 0, PAGE_READWRITE )) enabled = 0;
+    else if (interlocked_cmpxchg_ptr( (void **)&fast_sync_shm, ptr, NULL ))
+        NtUnmapViewOfSection( NtCurrentProcess(), ptr );
+    NtClose( mapping );
+    return enabled;
+}
+
+/* the access rights are mapped the same way as event_map_access and semaphore_map_access */
+static unsigned int get_fast_sync_access( ACCESS_MASK access, ACCESS_MASK modify )
+{
+    unsigned int ret = 0;
+
+    if (access & (SYNCHRONIZE | GENERIC_EXECUTE | GENERIC_ALL)) ret |= FAST_SYNC_WAIT;
+    if (access & (modify | GENERIC_WRITE | GENERIC_ALL)) ret |= FAST_SYNC_MODIFY;
+    return ret;
+}
+
+static void add_fast_sync_to_cache( HANDLE handle, int index, unsigned int access )
+{
+    unsigned int entry, idx = fast_sync_handle_to_index( handle, &entry );
+    union fast_sync_cache_entry cache;
+
+    if (!fast_sync_shm || index < 0 || !access) return;
+    if (entry >= FAST_SYNC_CACHE_ENTRIES) return;
+
+    if (!fast_sync_cache[entry])  /* do we need to allocate a new block of entries? */
+    {
+        void *ptr = RtlAllocateHeap( GetProcessHeap(), HEAP_ZERO_MEMORY,
+                                     FAST_SYNC_CACHE_BLOCK_SIZE * sizeof(union fast_sync_cache_entry) );
+        if (!ptr) return;
+        if (interlocked_cmpxchg_ptr( (void **)&fast_sync_cache[entry], ptr, NULL ))
+            RtlFreeHeap( GetProcessHeap(), 0, ptr );
+    }
+
+    cache.s.index  = index + 1;
+    cache.s.access = access;
+    cache.s.id     = fast_sync_shm[index].id;
+    set_fast_sync_cache_entry( &fast_sync_cache[entry][idx], cache.data );
+}
+
+/***********************************************************************
+ *           remove_fast_sync_from_cache
+ */
+void remove_fast_sync_from_cache( HANDLE handle )
+{
+    unsigned int entry, idx = fast_sync_handle_to_index( handle, &entry );
+
+    if (entry < FAST_SYNC_CACHE_ENTRIES && fast_sync_cache[entry])
+        set_fast_sync_cache_entry( &fast_sync_cache[entry][idx], 0 );
+}
+
+/* get the shared state of a handle, if it is cached with the needed access */
+static volatile fast_sync_shm_t *get_fast_sync( HANDLE handle, unsigned int access )
+{
+    unsigned int entry, idx = fast_sync_handle_to_index( handle, &entry );
+    union fast_sync_cache_entry cache;
+    volatile fast_sync_shm_t *shm;
+
+    if (entry >= FAST_SYNC_CACHE_ENTRIES || !fast_sync_cache[entry]) return NULL;
+
+    cache.data = interlocked_cmpxchg64( &fast_sync_cache[entry][idx].data, 0, 0 );
+    if (!cache.s.index || (cache.s.access & access) != access) return NULL;
+    shm = &fast_sync_shm[cache.s.index - 1];
+    /* the object has been destroyed, the handle must have been closed behind our back */
+    if (shm->id != cache.s.id) return NULL;
+    return shm;
+}
+
+/* change the shared value unless the server is checking it */
+static BOOL set_fast_sync_value( volatile fast_sync_shm_t *shm, unsigned int value, unsigned int *prev )
+{
+    unsigned int old;
+
+    do
+    {
+        old = shm->value;
+        if (old & FAST_SYNC_LOCKED) return FALSE;
+    }
+    while (interlocked_cmpxchg( (int *)&shm->value, value, old ) != old);
+    if (prev) *prev = old;
+    return TRUE;
+}
+
+/* threads waiting in the server have to be woken up by it */
+static void wake_fast_sync( HANDLE handle )
+{
+    SERVER_START_REQ( fast_sync_wake )
+    {
+        req->handle = wine_server_obj_handle( handle );
+        wine_server_call( req );
+    }
+    SERVER_END_REQ;
+}
+
+static NTSTATUS fast_set_event( HANDLE handle, unsigned int value )
+{
+    volatile fast_sync_shm_t *shm;
+
+    if (!(shm = get_fast_sync( handle, FAST_SYNC_MODIFY ))) return STATUS_NOT_IMPLEMENTED;
+    if (shm->type == FAST_SYNC_SEMAPHORE) return STATUS_NOT_IMPLEMENTED;
+    if (value && shm->waiters) return STATUS_NOT_IMPLEMENTED;
+    if (!set_fast_sync_value( shm, value, NULL )) return STATUS_NOT_IMPLEMENTED;
+    /* a thread may have started waiting before the value was set */
+    if (value && shm->waiters) wake_fast_sync( handle );
+    return STATUS_SUCCESS;
+}
+
+static NTSTATUS fast_release_semaphore( HANDLE handle, ULONG count, ULONG *previous )
+{
+    volatile fast_sync_shm_t *shm;
+    unsigned int old;
+
+    if (!(shm = get_fast_sync( handle, FAST_SYNC_MODIFY ))) return STATUS_NOT_IMPLEMENTED;
+    if (shm->type != FAST_SYNC_SEMAPHORE || shm->waiters) return STATUS_NOT_IMPLEMENTED;
+    do
+    {
+        old = shm->value;
+        if (old & FAST_SYNC_LOCKED) return STATUS_NOT_IMPLEMENTED;
+        if (old + count < old || old + count > shm->max) return STATUS_SEMAPHORE_LIMIT_EXCEEDED;
+    }
+    while (interlocked_cmpxchg( (int *)&shm->value, old + count, old ) != old);
+    if (previous) *previous = old;
+    if (shm->waiters) wake_fast_sync( handle );
+    return STATUS_SUCCESS;
+}
+
+/* acquire a signaled object; blocking and alertable waits are left to the server */
+static NTSTATUS fast_wait( HANDLE handle, BOOLEAN alertable, const LARGE_INTEGER *timeout )
+{
+    volatile fast_sync_shm_t *shm;
+    unsigned int value, new_value;
+
+    if (!(shm = get_fast_sync( handle, FAST_SYNC_WAIT ))) return STATUS_NOT_IMPLEMENTED;
+    for (;;)
+    {
+        value = shm->value;
+        if (value & FAST_SYNC_LOCKED) return STATUS_NOT_IMPLEMENTED;
+        if (!value)
+        {
+            if (alertable || !timeout || timeout->QuadPart) return STATUS_NOT_IMPLEMENTED;
+            /* like server_select, yield when the wait times out */
+            NtYieldExecution();
+            return STATUS_TIMEOUT;
+        }
+        switch (shm->type)
+        {
+        case FAST_SYNC_MANUAL_EVENT: return STATUS_WAIT_0;
+        case FAST_SYNC_AUTO_EVENT:   new_value = 0; break;
+        case FAST_SYNC_SEMAPHORE:    new_value = value - 1; break;
+        default:                     return STATUS_NOT_IMPLEMENTED;
+        }
+        if (interlocked_cmpxchg( (int *)&shm->value, new_value, value ) == value) return STATUS_WAIT_0;
+    }
+}
+
 /* creates a struct security_descriptor and contained information in one contiguous piece of memory */
 NTSTATUS alloc_object_attributes( const OBJECT_ATTRIBUTES *attr, struct object_attributes **ret,
                                   data_size_t *ret_len )
@@ -193,9 +562,13 @@ NTSTATUS WINAPI NtCreateSemaphore( OUT PHANDLE SemaphoreHandle,
         req->access  = access;
         req->initial = InitialCount;
         req->max     = MaximumCount;
+        req->fast_sync = init_fast_sync();
         wine_server_add_data( req, objattr, len );
         ret = wine_server_call( req );
         *SemaphoreHandle = wine_server_ptr_handle( reply->handle );
+        if (*SemaphoreHandle)
+            add_fast_sync_to_cache( *SemaphoreHandle, reply->fast_sync,
+                                    get_fast_sync_access( access, SEMAPHORE_MODIFY_STATE ));
     }
     SERVER_END_REQ;
 
@@ -266,6 +639,10 @@ NTSTATUS WINAPI NtQuerySemaphore( HANDLE handle, SEMAPHORE_INFORMATION_CLASS cla
 NTSTATUS WINAPI NtReleaseSemaphore( HANDLE handle, ULONG count, PULONG previous )
 {
     NTSTATUS ret;
+
+    if ((ret = fast_release_semaphore( handle, count, previous )) != STATUS_NOT_IMPLEMENTED)
+        return ret;
+
     SERVER_START_REQ( release_semaphore )
     {
         req->handle = wine_server_obj_handle( handle );
@@ -301,9 +678,13 @@ NTSTATUS WINAPI NtCreateEvent( PHANDLE EventHandle, ACCESS_MASK DesiredAccess,
         req->access = DesiredAccess;
         req->manual_reset = (type == NotificationEvent);
         req->initial_state = InitialState;
+        req->fast_sync = init_fast_sync();
         wine_server_add_data( req, objattr, len );
         ret = wine_server_call( req );
         *EventHandle = wine_server_ptr_handle( reply->handle );
+        if (*EventHandle)
+            add_fast_sync_to_cache( *EventHandle, reply->fast_sync,
+                                    get_fast_sync_access( DesiredAccess, EVENT_MODIFY_STATE ));
     }
     SERVER_END_REQ;
 
@@ -346,6 +727,8 @@ NTSTATUS WINAPI NtSetEvent( HANDLE handle, PULONG NumberOfThreadsReleased )
 
     /* FIXME: set NumberOfThreadsReleased */
 
+    if ((ret = fast_set_event( handle, 1 )) != STATUS_NOT_IMPLEMENTED) return ret;
+
     SERVER_START_REQ( event_op )
     {
         req->handle = wine_server_obj_handle( handle );
@@ -366,6 +749,8 @@ NTSTATUS WINAPI NtResetEvent( HANDLE handle, PULONG NumberOfThreadsReleased )
     /* resetting an event can't release any thread... */
     if (NumberOfThreadsReleased) *NumberOfThreadsReleased = 0;
 
+    if ((ret = fast_set_event( handle, 0 )) != STATUS_NOT_IMPLEMENTED) return ret;
+
     SERVER_START_REQ( event_op )
     {
         req->handle = wine_server_obj_handle( handle );
@@ -1024,6 +1409,9 @@ NTSTATUS WINAPI NtWaitForMultipleObjects( DWORD count, const HANDLE *handles,
  */
 NTSTATUS WINAPI NtWaitForSingleObject(HANDLE handle, BOOLEAN alertable, const LARGE_INTEGER *timeout )
 {
+    NTSTATUS ret;
+
+    if ((ret = fast_wait( handle, alertable, timeout )) != STATUS_NOT_IMPLEMENTED) return ret;
     return wait_objects( 1, &handle, FALSE, alertable, timeout );
 }
 
@@ -1307,6 +1695,58 @@ NTSTATUS WINAPI NtRemoveIoCompletion( HANDLE CompletionPort, PULONG_PTR Completi
     return status;
 }
 
+/******************************************************************
+ *              NtRemoveIoCompletionEx (NTDLL.@)
+ *              ZwRemoveIoCompletionEx (NTDLL.@)
+ *
+ * (Wait for and) retrieve up to count completion messages from completion object's queue.
+ * Messages that are already queued are retrieved in batches, one server call each.
+ */
+NTSTATUS WINAPI NtRemoveIoCompletionEx( HANDLE port, FILE_IO_COMPLETION_INFORMATION *info, ULONG count,
+                                        ULONG *written, LARGE_INTEGER *timeout, BOOLEAN alertable )
+{
+    struct completion_info packets[64];
+    NTSTATUS status;
+    ULONG i, n, total = 0;
+
+    TRACE("(%p, %p, %u, %p, %p, %u)\n", port, info, count, written, timeout, alertable);
+
+    if (!count) return STATUS_INVALID_PARAMETER;
+
+    for (;;)
+    {
+        while (total < count)
+        {
+            SERVER_START_REQ( remove_completions )
+            {
+                req->handle = wine_server_obj_handle( port );
+                wine_server_set_reply( req, packets,
+                                       min( count - total, sizeof(packets)/sizeof(packets[0]) ) * sizeof(packets[0]) );
+                status = wine_server_call( req );
+                n = wine_server_reply_size( reply ) / sizeof(packets[0]);
+            }
+            SERVER_END_REQ;
+            if (status) break;
+
+            for (i = 0; i < n; i++, total++)
+            {
+                info[total].CompletionKey             = packets[i].ckey;
+                info[total].CompletionValue           = packets[i].cvalue;
+                info[total].IoStatusBlock.Information = packets[i].information;
+                info[total].IoStatusBlock.u.Status    = packets[i].status;
+            }
+            if (n < sizeof(packets)/sizeof(packets[0])) break;  /* queue is empty */
+        }
+        if (total || status != STATUS_PENDING) break;
+
+        status = NtWaitForSingleObject( port, alertable, timeout );
+        if (status != WAIT_OBJECT_0) break;
+    }
+
+    *written = total;
+    return total ? STATUS_SUCCESS : status;
+}
+
 /******************************************************************
  *              NtOpenIoCompletion (NTDLL.@)
  *              ZwOpenIoCompletion (NTDLL.@)
@@ -1391,8 +1831,9 @@ NTSTATUS WINAPI NtQueryIoCompletion( HANDLE CompletionPort, IO_COMPLETION_INFORM
     return status;
 }
 
+/* the event, if any, is signaled in the same server call */
 NTSTATUS NTDLL_AddCompletion( HANDLE hFile, ULONG_PTR CompletionValue,
-                              NTSTATUS CompletionStatus, ULONG Information )
+                              NTSTATUS CompletionStatus, ULONG Information, HANDLE event )
 {
     NTSTATUS status;
 
@@ -1402,6 +1843,7 @@ NTSTATUS NTDLL_AddCompletion( HANDLE hFile, ULONG_PTR CompletionValue,
         req->cvalue      = CompletionValue;
         req->status      = CompletionStatus;
         req->information = Information;
+        req->event       = wine_server_obj_handle( event );
         status = wine_server_call( req );
     }
     SERVER_END_REQ;
@@ -1789,7 +2231,8 @@ void WINAPI RtlInitializeConditionVariable( RTL_CONDITION_VARIABLE *variable )
  */
 void WINAPI RtlWakeConditionVariable( RTL_CONDITION_VARIABLE *variable )
 {
-    if (interlocked_dec_if_nonzero( (int *)&variable->Ptr ))
+    if (fast_wake_cv( variable, 1 ) == STATUS_NOT_IMPLEMENTED &&
+        interlocked_dec_if_nonzero( (int *)&variable->Ptr ))
         NtReleaseKeyedEvent( keyed_event, &variable->Ptr, FALSE, NULL );
 }
 
@@ -1800,7 +2243,12 @@ void WINAPI RtlWakeConditionVariable( RTL_CONDITION_VARIABLE *variable )
  */
 void WINAPI RtlWakeAllConditionVariable( RTL_CONDITION_VARIABLE *variable )
 {
-    int val = interlocked_xchg( (int *)&variable->Ptr, 0 );
+    int val;
+
+    if (fast_wake_cv( variable, INT_MAX ) != STATUS_NOT_IMPLEMENTED)
+        return;
+
+    val = interlocked_xchg( (int *)&variable->Ptr, 0 );
     while (val-- > 0)
         NtReleaseKeyedEvent( keyed_event, &variable->Ptr, FALSE, NULL );
 }
@@ -1824,6 +2272,10 @@ NTSTATUS WINAPI RtlSleepConditionVariableCS( RTL_CONDITION_VARIABLE *variable, R
                                              const LARGE_INTEGER *timeout )
 {
     NTSTATUS status;
+
+    if ((status = fast_sleep_cs_cv( variable, crit, timeout )) != STATUS_NOT_IMPLEMENTED)
+        return status;
+
     interlocked_xchg_add( (int *)&variable->Ptr, 1 );
     RtlLeaveCriticalSection( crit );
 
@@ -1861,6 +2313,10 @@ NTSTATUS WINAPI RtlSleepConditionVariableSRW( RTL_CONDITION_VARIABLE *variable,
                                               const LARGE_INTEGER *timeout, ULONG flags )
 {
     NTSTATUS status;
+
+    if ((status = fast_sleep_srw_cv( variable, lock, timeout, flags )) != STATUS_NOT_IMPLEMENTED)
+        return status;
+
     interlocked_xchg_add( (int *)&variable->Ptr, 1 );
 
     if (flags & RTL_CONDITION_VARIABLE_LOCKMODE_SHARED)
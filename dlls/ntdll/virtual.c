@@ -54,6 +54,7 @@
 #include "wine/server.h"
 #include "wine/exception.h"
 #include "wine/list.h"
+#include "wine/rbtree.h"
 #include "wine/debug.h"
 #include "ntdll_misc.h"
 
@@ -67,7 +68,7 @@ WINE_DECLARE_DEBUG_CHANNEL(module);
 /* File view */
 struct file_view
 {
-    struct list   entry;       /* Entry in global view list */
+    struct wine_rb_entry entry; /* Entry in global view tree */
     void         *base;        /* Base address */
     size_t        size;        /* Size in bytes */
     HANDLE        mapping;     /* Handle to the file mapping */
@@ -98,7 +99,16 @@ static const BYTE VIRTUAL_Win32Flags[16] =
     PAGE_EXECUTE_WRITECOPY      /* READ | WRITE | EXEC | WRITECOPY */
 };
 
-static struct list views_list = LIST_INIT(views_list);
+static int compare_view( const void *addr, const struct wine_rb_entry *entry )
+{
+    struct file_view *view = WINE_RB_ENTRY_VALUE( entry, struct file_view, entry );
+
+    if (addr < view->base) return -1;
+    if (addr > view->base) return 1;
+    return 0;
+}
+
+static struct wine_rb_tree views_tree = { compare_view };
 
 static RTL_CRITICAL_SECTION csVirtual;
 static RTL_CRITICAL_SECTION_DEBUG critsect_debug =
@@ -235,7 +245,7 @@ static void VIRTUAL_Dump(void)
 
     TRACE( "Dump of all virtual memory views:\n" );
     server_enter_uninterrupted_section( &csVirtual, &sigset );
-    LIST_FOR_EACH_ENTRY( view, &views_list, struct file_view, entry )
+    WINE_RB_FOR_EACH_ENTRY( view, &views_tree, struct file_view, entry )
     {
         VIRTUAL_DumpView( view );
     }
@@ -258,15 +268,18 @@ static void VIRTUAL_Dump(void)
  */
 static struct file_view *VIRTUAL_FindView( const void *addr, size_t size )
 {
-    struct file_view *view;
+    struct wine_rb_entry *ptr = views_tree.root;
+
+    if ((const char *)addr + size < (const char *)addr) return NULL; /* overflow */
 
-    LIST_FOR_EACH_ENTRY( view, &views_list, struct file_view, entry )
+    while (ptr)
     {
-        if (view->base > addr) break;  /* no matching view */
-        if ((const char *)view->base + view->size <= (const char *)addr) continue;
-        if ((const char *)view->base + view->size < (const char *)addr + size) break;  /* size too large */
-        if ((const char *)addr + size < (const char *)addr) break; /* overflow */
-        return view;
+        struct file_view *view = WINE_RB_ENTRY_VALUE( ptr, struct file_view, entry );
+
+        if (view->base > addr) ptr = ptr->left;
+        else if ((const char *)view->base + view->size <= (const char *)addr) ptr = ptr->right;
+        else if ((const char *)view->base + view->size < (const char *)addr + size) break;  /* size too large */
+        else return view;
     }
     return NULL;
 }
@@ -291,14 +304,61 @@ static inline UINT_PTR get_mask( ULONG zero_bits )
  */
 static struct file_view *find_view_range( const void *addr, size_t size )
 {
-    struct file_view *view;
+    struct wine_rb_entry *ptr = views_tree.root;
+    struct file_view *first = NULL;
 
-    LIST_FOR_EACH_ENTRY( view, &views_list, struct file_view, entry )
+    while (ptr)
     {
-        if ((const char *)view->base >= (const char *)addr + size) break;
-        if ((const char *)view->base + view->size > (const char *)addr) return view;
+        struct file_view *view = WINE_RB_ENTRY_VALUE( ptr, struct file_view, entry );
+
+        if ((const char *)view->base >= (const char *)addr + size) ptr = ptr->left;
+        else if ((const char *)view->base + view->size <= (const char *)addr) ptr = ptr->right;
+        else
+        {
+            first = view;
+            ptr = ptr->left;
+        }
     }
-    return NULL;
+    return first;
+}
+
+
+/***********************************************************************
+ *           find_view_inside_range
+ *
+ * Find the first (resp. last for top-down) view inside the specified range,
+ * and shrink the range to exclude the views overlapping its boundaries.
+ * The csVirtual section must be held by caller.
+ */
+static struct wine_rb_entry *find_view_inside_range( void **base_ptr, void **end_ptr, int top_down )
+{
+    struct wine_rb_entry *first = NULL, *ptr = views_tree.root;
+    void *base = *base_ptr, *end = *end_ptr;
+
+    while (ptr)
+    {
+        struct file_view *view = WINE_RB_ENTRY_VALUE( ptr, struct file_view, entry );
+
+        if ((char *)view->base + view->size >= (char *)end)
+        {
+            end = min( end, view->base );
+            ptr = ptr->left;
+        }
+        else if (view->base <= base)
+        {
+            base = max( (char *)base, (char *)view->base + view->size );
+            ptr = ptr->right;
+        }
+        else
+        {
+            first = ptr;
+            ptr = top_down ? ptr->right : ptr->left;
+        }
+    }
+
+    *base_ptr = base;
+    *end_ptr = end;
+    return first;
 }
 
 
@@ -310,7 +370,7 @@ static struct file_view *find_view_range( const void *addr, size_t size )
  */
 static void *find_free_area( void *base, void *end, size_t size, size_t mask, int top_down )
 {
-    struct list *ptr;
+    struct wine_rb_entry *ptr = find_view_inside_range( &base, &end, top_down );
     void *start;
 
     if (top_down)
@@ -318,9 +378,9 @@ static void *find_free_area( void *base, void *end, size_t size, size_t mask, in
         start = ROUND_ADDR( (char *)end - size, mask );
         if (start >= end || start < base) return NULL;
 
-        for (ptr = views_list.prev; ptr != &views_list; ptr = ptr->prev)
+        for ( ; ptr; ptr = wine_rb_prev( ptr ))
         {
-            struct file_view *view = LIST_ENTRY( ptr, struct file_view, entry );
+            struct file_view *view = WINE_RB_ENTRY_VALUE( ptr, struct file_view, entry );
 
             if ((char *)view->base + view->size <= (char *)start) break;
             if ((char *)view->base >= (char *)start + size) continue;
@@ -332,11 +392,11 @@ static void *find_free_area( void *base, void *end, size_t size, size_t mask, in
     else
     {
         start = ROUND_ADDR( (char *)base + mask, mask );
-        if (start >= end || (char *)end - (char *)start < size) return NULL;
+        if (!start || start >= end || (char *)end - (char *)start < size) return NULL;
 
-        for (ptr = views_list.next; ptr != &views_list; ptr = ptr->next)
+        for ( ; ptr; ptr = wine_rb_next( ptr ))
         {
-            struct file_view *view = LIST_ENTRY( ptr, struct file_view, entry );
+            struct file_view *view = WINE_RB_ENTRY_VALUE( ptr, struct file_view, entry );
 
             if ((char *)view->base >= (char *)start + size) break;
             if ((char *)view->base + view->size <= (char *)start) continue;
@@ -387,7 +447,7 @@ static void remove_reserved_area( void *addr, size_t size )
     wine_mmap_remove_reserved_area( addr, size, 0 );
 
     /* unmap areas not covered by an existing view */
-    LIST_FOR_EACH_ENTRY( view, &views_list, struct file_view, entry )
+    WINE_RB_FOR_EACH_ENTRY( view, &views_tree, struct file_view, entry )
     {
         if ((char *)view->base >= (char *)addr + size)
         {
@@ -439,7 +499,7 @@ static inline void unmap_area( void *addr, size_t size )
 static void delete_view( struct file_view *view ) /* [in] View */
 {
     if (!(view->protect & VPROT_SYSTEM)) unmap_area( view->base, view->size );
-    list_remove( &view->entry );
+    wine_rb_remove( &views_tree, &view->entry );
     if (view->mapping) close_handle( view->mapping );
     RtlFreeHeap( virtual_heap, 0, view );
 }
@@ -452,8 +512,7 @@ static void delete_view( struct file_view *view ) /* [in] View */
  */
 static NTSTATUS create_view( struct file_view **view_ret, void *base, size_t size, unsigned int vprot )
 {
-    struct file_view *view;
-    struct list *ptr;
+    struct file_view *view, *overlap;
     int unix_prot = VIRTUAL_GetUnixProt( vprot );
 
     assert( !((UINT_PTR)base & page_mask) );
@@ -474,44 +533,23 @@ static NTSTATUS create_view( struct file_view **view_ret, void *base, size_t siz
     view->protect = vprot;
     memset( view->prot, vprot, size >> page_shift );
 
-    /* Insert it in the linked list */
-
-    LIST_FOR_EACH( ptr, &views_list )
-    {
-        struct file_view *next = LIST_ENTRY( ptr, struct file_view, entry );
-        if (next->base > base) break;
-    }
-    list_add_before( ptr, &view->entry );
-
     /* Check for overlapping views. This can happen if the previous view
      * was a system view that got unmapped behind our back. In that case
      * we recover by simply deleting it. */
 
-    if ((ptr = list_prev( &views_list, &view->entry )) != NULL)
+    while ((overlap = find_view_range( base, size )))
     {
-        struct file_view *prev = LIST_ENTRY( ptr, struct file_view, entry );
-        if ((char *)prev->base + prev->size > (char *)base)
-        {
-            TRACE( "overlapping prev view %p-%p for %p-%p\n",
-                   prev->base, (char *)prev->base + prev->size,
-                   base, (char *)base + view->size );
-            assert( prev->protect & VPROT_SYSTEM );
-            delete_view( prev );
-        }
-    }
-    if ((ptr = list_next( &views_list, &view->entry )) != NULL)
-    {
-        struct file_view *next = LIST_ENTRY( ptr, struct file_view, entry );
-        if ((char *)base + view->size > (char *)next->base)
-        {
-            TRACE( "overlapping next view %p-%p for %p-%p\n",
-                   next->base, (char *)next->base + next->size,
-                   base, (char *)base + view->size );
-            assert( next->protect & VPROT_SYSTEM );
-            delete_view( next );
-        }
+        TRACE( "overlapping view %p-%p for %p-%p\n",
+               overlap->base, (char *)overlap->base + overlap->size,
+               base, (char *)base + view->size );
+        assert( overlap->protect & VPROT_SYSTEM );
+        delete_view( overlap );
     }
 
+    /* Insert it in the tree */
+
+    wine_rb_put( &views_tree, view->base, &view->entry );
+
     *view_ret = view;
     VIRTUAL_DEBUG_DUMP_VIEW( view );
 
@@ -985,13 +1023,13 @@ static NTSTATUS allocate_dos_memory( struct file_view **view, unsigned int vprot
     void * const low_64k = (void *)0x10000;
     const size_t dosmem_size = 0x110000;
     int unix_prot = VIRTUAL_GetUnixProt( vprot );
-    struct list *ptr;
+    struct wine_rb_entry *ptr;
 
     /* check for existing view */
 
-    if ((ptr = list_head( &views_list )))
+    if ((ptr = wine_rb_head( views_tree.root )))
     {
-        struct file_view *first_view = LIST_ENTRY( ptr, struct file_view, entry );
+        struct file_view *first_view = WINE_RB_ENTRY_VALUE( ptr, struct file_view, entry );
         if (first_view->base < (void *)dosmem_size) return STATUS_CONFLICTING_ADDRESSES;
     }
 
@@ -1753,7 +1791,7 @@ void VIRTUAL_SetForceExec( BOOL enable )
     {
         force_exec_prot = enable;
 
-        LIST_FOR_EACH_ENTRY( view, &views_list, struct file_view, entry )
+        WINE_RB_FOR_EACH_ENTRY( view, &views_tree, struct file_view, entry )
         {
             UINT i, count;
             char *addr = view->base;
@@ -2254,8 +2292,8 @@ NTSTATUS WINAPI NtQueryVirtualMemory( HANDLE process, LPCVOID addr,
                                       SIZE_T len, SIZE_T *res_len )
 {
     struct file_view *view;
-    char *base, *alloc_base = 0;
-    struct list *ptr;
+    char *base, *alloc_base = 0, *alloc_end = working_set_limit;
+    struct wine_rb_entry *ptr;
     SIZE_T size = 0;
     MEMORY_BASIC_INFORMATION *info = buffer;
     sigset_t sigset;
@@ -2311,31 +2349,31 @@ NTSTATUS WINAPI NtQueryVirtualMemory( HANDLE process, LPCVOID addr,
     /* Find the view containing the address */
 
     server_enter_uninterrupted_section( &csVirtual, &sigset );
-    ptr = list_head( &views_list );
-    for (;;)
+    ptr = views_tree.root;
+    view = NULL;
+    while (ptr)
     {
-        if (!ptr)
+        struct file_view *cur = WINE_RB_ENTRY_VALUE( ptr, struct file_view, entry );
+
+        if ((char *)cur->base > base)
         {
-            size = (char *)working_set_limit - alloc_base;
-            view = NULL;
-            break;
+            alloc_end = cur->base;
+            ptr = ptr->left;
         }
-        view = LIST_ENTRY( ptr, struct file_view, entry );
-        if ((char *)view->base > base)
+        else if ((char *)cur->base + cur->size <= base)
         {
-            size = (char *)view->base - alloc_base;
-            view = NULL;
-            break;
+            alloc_base = (char *)cur->base + cur->size;
+            ptr = ptr->right;
         }
-        if ((char *)view->base + view->size > base)
+        else
         {
+            view = cur;
             alloc_base = view->base;
-            size = view->size;
+            alloc_end = (char *)view->base + view->size;
             break;
         }
-        alloc_base = (char *)view->base + view->size;
-        ptr = list_next( &views_list, ptr );
     }
+    size = alloc_end - alloc_base;
 
     /* Fill the info structure */
 
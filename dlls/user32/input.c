@@ -233,16 +233,67 @@ void WINAPI mouse_event( DWORD dwFlags, DWORD dx, DWORD dy,
 }
 
 
+/***********************************************************************
+ *		get_desktop_shm
+ *
+ * Map the input state of the thread desktop shared by the server.
+ */
+static const desktop_shm_t *get_desktop_shm(void)
+{
+    struct user_thread_info *thread_info = get_user_thread_info();
+    struct user_key_state_info *key_state_info = thread_info->key_state;
+    HANDLE mapping = 0;
+
+    if (!key_state_info)
+    {
+        key_state_info = HeapAlloc( GetProcessHeap(), HEAP_ZERO_MEMORY, sizeof(*key_state_info) );
+        if (!(thread_info->key_state = key_state_info)) return NULL;
+    }
+    if (key_state_info->desktop_shm) return key_state_info->desktop_shm;
+
+    SERVER_START_REQ( get_desktop_shm )
+    {
+        if (!wine_server_call( req )) mapping = wine_server_ptr_handle( reply->handle );
+    }
+    SERVER_END_REQ;
+    if (!mapping) return NULL;
+    key_state_info->desktop_shm = MapViewOfFile( mapping, FILE_MAP_READ, 0, 0, 0 );
+    CloseHandle( mapping );
+    return key_state_info->desktop_shm;
+}
+
+
 /***********************************************************************
  *		GetCursorPos (USER32.@)
  */
 BOOL WINAPI DECLSPEC_HOTPATCH GetCursorPos( POINT *pt )
 {
+    const volatile desktop_shm_t *shm;
     BOOL ret;
     DWORD last_change;
+    unsigned int seq;
 
     if (!pt) return FALSE;
 
+    if ((shm = get_desktop_shm()))
+    {
+        /* the server increments the sequence number before and after each update */
+        do
+        {
+            while ((seq = shm->seq) & 1) YieldProcessor();
+            /* order the data reads after the first sequence read and before the second one */
+            __sync_synchronize();
+            pt->x = shm->cursor_x;
+            pt->y = shm->cursor_y;
+            last_change = shm->cursor_change;
+            __sync_synchronize();
+        } while (shm->seq != seq);
+
+        /* query new position from graphics driver if we haven't updated recently */
+        if (GetTickCount() - last_change > 100) return USER_Driver->pGetCursorPos( pt );
+        return TRUE;
+    }
+
     SERVER_START_REQ( set_cursor )
     {
         if ((ret = !wine_server_call( req )))
@@ -369,9 +420,11 @@ static void check_for_events( UINT flags )
  */
 SHORT WINAPI DECLSPEC_HOTPATCH GetAsyncKeyState( INT key )
 {
-    struct user_key_state_info *key_state_info = get_user_thread_info()->key_state;
+    struct user_key_state_info *key_state_info;
+    const volatile desktop_shm_t *shm;
     INT counter = global_key_state_counter;
     SHORT ret;
+    BYTE state;
 
     if (key < 0 || key >= 256) return 0;
 
@@ -379,6 +432,11 @@ SHORT WINAPI DECLSPEC_HOTPATCH GetAsyncKeyState( INT key )
 
     if ((ret = USER_Driver->pGetAsyncKeyState( key )) == -1)
     {
+        /* the server only needs to be called to clear the "pressed since last call" bit */
+        if ((shm = get_desktop_shm()) && !((state = shm->keystate[key]) & 0x40))
+            return (state & 0x80) ? 0x8000 : 0;
+
+        key_state_info = get_user_thread_info()->key_state;
         if (key_state_info &&
             !(key_state_info->state[key] & 0xc0) &&
             key_state_info->counter == counter &&
@@ -2723,6 +2723,70 @@ static inline void call_sendmsg_callback( SENDASYNCPROC callback, HWND hwnd, UIN
 }
 
 
+/***********************************************************************
+ *           get_server_queue_handle
+ *
+ * Get a handle to the server message queue for the current thread.
+ */
+static HANDLE get_server_queue_handle(void)
+{
+    struct user_thread_info *thread_info = get_user_thread_info();
+    HANDLE ret, mapping = 0;
+
+    if (!(ret = thread_info->server_queue))
+    {
+        SERVER_START_REQ( get_msg_queue )
+        {
+            wine_server_call( req );
+            ret = wine_server_ptr_handle( reply->handle );
+            mapping = wine_server_ptr_handle( reply->shm_mapping );
+        }
+        SERVER_END_REQ;
+        thread_info->server_queue = ret;
+        if (!ret) ERR( "Cannot get server thread queue\n" );
+        if (mapping)
+        {
+            thread_info->queue_shm = MapViewOfFile( mapping, FILE_MAP_READ, 0, 0, 0 );
+            CloseHandle( mapping );
+        }
+    }
+    return ret;
+}
+
+
+/***********************************************************************
+ *           is_queue_idle
+ *
+ * Check the queue state shared with the server to find out whether a
+ * get_message request with the specified parameters would return nothing,
+ * so that the server call can be skipped.
+ */
+static BOOL is_queue_idle( HWND hwnd, UINT flags, UINT changed_mask )
+{
+    struct user_thread_info *thread_info = get_user_thread_info();
+    const volatile queue_shm_t *shm = thread_info->queue_shm;
+    UINT filter = flags >> 16;
+
+    if (!shm)
+    {
+        /* map the shared state the first time around */
+        if (thread_info->server_queue || !get_server_queue_handle()) return FALSE;
+        if (!(shm = thread_info->queue_shm)) return FALSE;
+    }
+    /* the server signals the idle event for these */
+    if (hwnd == HWND_BROADCAST || hwnd == HWND_TOPMOST) return FALSE;
+    /* a failed request stores the wake masks, make sure they are already set */
+    if (thread_info->wake_mask != (changed_mask & (QS_SENDMESSAGE | QS_SMRESULT)) ||
+        thread_info->changed_mask != changed_mask) return FALSE;
+    /* the server uses the request time to detect hung applications */
+    if (GetTickCount() - thread_info->get_msg_time >= 1000) return FALSE;
+
+    if (!filter) filter = QS_ALLINPUT;
+    if (filter & QS_POSTMESSAGE) filter |= QS_ALLPOSTMESSAGE;
+    return !(shm->wake_bits & (filter | QS_SENDMESSAGE));
+}
+
+
 /***********************************************************************
  *           peek_message
  *
@@ -2738,6 +2802,8 @@ static BOOL peek_message( MSG *msg, HWND hwnd, UINT first, UINT last, UINT flags
     void *buffer;
     size_t buffer_size = 256;
 
+    if (is_queue_idle( hwnd, flags, changed_mask )) return FALSE;
+
     if (!(buffer = HeapAlloc( GetProcessHeap(), 0, buffer_size ))) return FALSE;
 
     if (!first && !last) last = ~0;
@@ -2749,6 +2815,7 @@ static BOOL peek_message( MSG *msg, HWND hwnd, UINT first, UINT last, UINT flags
         size_t size = 0;
         const message_data_t *msg_data = buffer;
 
+        thread_info->get_msg_time = GetTickCount();
         SERVER_START_REQ( get_message )
         {
             req->flags     = flags;
@@ -2975,31 +3042,6 @@ static inline void process_sent_messages(void)
 }
 
 
-/***********************************************************************
- *           get_server_queue_handle
- *
- * Get a handle to the server message queue for the current thread.
- */
-static HANDLE get_server_queue_handle(void)
-{
-    struct user_thread_info *thread_info = get_user_thread_info();
-    HANDLE ret;
-
-    if (!(ret = thread_info->server_queue))
-    {
-        SERVER_START_REQ( get_msg_queue )
-        {
-            wine_server_call( req );
-            ret = wine_server_ptr_handle( reply->handle );
-        }
-        SERVER_END_REQ;
-        thread_info->server_queue = ret;
-        if (!ret) ERR( "Cannot get server thread queue\n" );
-    }
-    return ret;
-}
-
-
 /***********************************************************************
  *           wait_message_reply
  *
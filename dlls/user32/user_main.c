@@ -308,7 +308,10 @@ static void thread_detach(void)
     if (thread_info->top_window) WIN_DestroyThreadWindows( thread_info->top_window );
     if (thread_info->msg_window) WIN_DestroyThreadWindows( thread_info->msg_window );
     CloseHandle( thread_info->server_queue );
+    if (thread_info->queue_shm) UnmapViewOfFile( thread_info->queue_shm );
     HeapFree( GetProcessHeap(), 0, thread_info->wmchar_data );
+    if (thread_info->key_state && thread_info->key_state->desktop_shm)
+        UnmapViewOfFile( thread_info->key_state->desktop_shm );
     HeapFree( GetProcessHeap(), 0, thread_info->key_state );
     HeapFree( GetProcessHeap(), 0, thread_info->rawinput );
 
@@ -181,10 +181,12 @@ struct user_thread_info
     DWORD                         GetMessagePosVal;       /* Value for GetMessagePos */
     ULONG_PTR                     GetMessageExtraInfoVal; /* Value for GetMessageExtraInfo */
     UINT                          active_hooks;           /* Bitmap of active hooks */
+    DWORD                         get_msg_time;           /* Time of last get_message server call */
     struct user_key_state_info   *key_state;              /* Cache of global key state */
     HWND                          top_window;             /* Desktop window */
     HWND                          msg_window;             /* HWND_MESSAGE parent window */
     RAWINPUT                     *rawinput;
+    const void                   *queue_shm;              /* Queue state shared with the server */
 };
 
 C_ASSERT( sizeof(struct user_thread_info) <= sizeof(((TEB *)0)->Win32ClientInfo) );
@@ -198,6 +200,7 @@ struct user_key_state_info
     UINT                          time;                   /* Time of last key state refresh */
     INT                           counter;                /* Counter to invalidate the key state */
     BYTE                          state[256];             /* State for each key */
+    const void                   *desktop_shm;            /* Desktop input state shared with the server */
 };
 
 struct hook_extra_info
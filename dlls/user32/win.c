@@ -809,6 +809,146 @@ ULONG WIN_SetStyle( HWND hwnd, ULONG set_bits, ULONG clear_bits )
 }
 
 
+/***********************************************************************
+ *           get_window_shm
+ *
+ * Map the window information shared by the server.
+ */
+static const window_shm_t *get_window_shm(void)
+{
+    static const window_shm_t *window_shm;
+    static BOOL failed;
+    HANDLE mapping = 0;
+    void *ptr = NULL;
+
+    if (window_shm || failed) return window_shm;
+
+    SERVER_START_REQ( get_window_shm )
+    {
+        if (!wine_server_call( req )) mapping = wine_server_ptr_handle( reply->handle );
+    }
+    SERVER_END_REQ;
+    if (mapping)
+    {
+        ptr = MapViewOfFile( mapping, FILE_MAP_READ, 0, 0, 0 );
+        CloseHandle( mapping );
+    }
+    if (!ptr)
+    {
+        failed = TRUE;
+        return NULL;
+    }
+    if (InterlockedCompareExchangePointer( (void **)&window_shm, ptr, NULL )) UnmapViewOfFile( ptr );
+    return window_shm;
+}
+
+
+/***********************************************************************
+ *           get_window_shm_info
+ *
+ * Get a consistent copy of the server information of a window without a
+ * server round trip. Returns FALSE if the server needs to be queried.
+ */
+static BOOL get_window_shm_info( HWND hwnd, window_shm_t *info )
+{
+    const volatile window_shm_t *shm;
+    WORD index = USER_HANDLE_TO_INDEX( hwnd );
+    unsigned int seq;
+
+    if (index >= NB_USER_HANDLES || !(shm = get_window_shm())) return FALSE;
+    shm += index;
+
+    /* the server increments the sequence number before and after each update */
+    for (;;)
+    {
+        seq = shm->seq;
+        if (!(seq & 1))
+        {
+            /* order the data reads after the first sequence read and before the second one */
+            __sync_synchronize();
+            info->handle   = shm->handle;
+            info->parent   = shm->parent;
+            info->owner    = shm->owner;
+            info->style    = shm->style;
+            info->ex_style = shm->ex_style;
+            info->window   = shm->window;
+            info->client   = shm->client;
+            __sync_synchronize();
+            if (shm->seq == seq) break;
+        }
+    }
+
+    if (!info->handle) return FALSE;
+    /* same generation check as the server */
+    if (HIWORD(hwnd) && HIWORD(hwnd) != 0xffff && info->handle != HandleToULong(hwnd)) return FALSE;
+    return TRUE;
+}
+
+
+/***********************************************************************
+ *           get_window_shm_rectangles
+ *
+ * Get the rectangles of a window from another process through the
+ * shared window information, see get_window_rectangles in the server.
+ */
+static BOOL get_window_shm_rectangles( HWND hwnd, enum coords_relative relative,
+                                       RECT *rectWindow, RECT *rectClient )
+{
+    window_shm_t info, parent;
+    RECT window_rect, client_rect, rect;
+    user_handle_t handle;
+    unsigned int depth = 0;
+
+    if (!get_window_shm_info( hwnd, &info )) return FALSE;
+
+    SetRect( &window_rect, info.window.left, info.window.top, info.window.right, info.window.bottom );
+    SetRect( &client_rect, info.client.left, info.client.top, info.client.right, info.client.bottom );
+
+    switch (relative)
+    {
+    case COORDS_CLIENT:
+        rect = client_rect;
+        OffsetRect( &window_rect, -rect.left, -rect.top );
+        OffsetRect( &client_rect, -rect.left, -rect.top );
+        if (info.ex_style & WS_EX_LAYOUTRTL) mirror_rect( &rect, &window_rect );
+        break;
+    case COORDS_WINDOW:
+        rect = window_rect;
+        OffsetRect( &window_rect, -rect.left, -rect.top );
+        OffsetRect( &client_rect, -rect.left, -rect.top );
+        if (info.ex_style & WS_EX_LAYOUTRTL) mirror_rect( &rect, &client_rect );
+        break;
+    case COORDS_PARENT:
+        if (!info.parent) break;
+        if (!get_window_shm_info( wine_server_ptr_handle( info.parent ), &parent )) return FALSE;
+        if (parent.ex_style & WS_EX_LAYOUTRTL)
+        {
+            SetRect( &rect, parent.client.left, parent.client.top,
+                     parent.client.right, parent.client.bottom );
+            mirror_rect( &rect, &window_rect );
+            mirror_rect( &rect, &client_rect );
+        }
+        break;
+    case COORDS_SCREEN:
+        for (handle = info.parent; handle; handle = parent.parent)
+        {
+            if (!get_window_shm_info( wine_server_ptr_handle( handle ), &parent )) return FALSE;
+            if (!parent.parent) break;  /* desktop window */
+            /* a concurrent update could make the chain loop */
+            if (++depth >= NB_USER_HANDLES) return FALSE;
+            OffsetRect( &window_rect, parent.client.left, parent.client.top );
+            OffsetRect( &client_rect, parent.client.left, parent.client.top );
+        }
+        break;
+    default:
+        return FALSE;
+    }
+    if (rectWindow) *rectWindow = window_rect;
+    if (rectClient) *rectClient = client_rect;
+    return TRUE;
+}
+
+
 /***********************************************************************
  *           WIN_GetRectangles
  *
@@ -916,6 +1056,8 @@ BOOL WIN_GetRectangles( HWND hwnd, enum coords_relative relative, RECT *rectWind
     }
 
 other_process:
+    if (get_window_shm_rectangles( hwnd, relative, rectWindow, rectClient )) return TRUE;
+
     SERVER_START_REQ( get_window_rectangles )
     {
         req->handle = wine_server_user_handle( hwnd );
@@ -2271,11 +2413,15 @@ static LONG_PTR WIN_GetWindowLong( HWND hwnd, INT offset, UINT size, BOOL unicod
 
     if (wndPtr == WND_OTHER_PROCESS)
     {
+        window_shm_t info;
+
         if (offset == GWLP_WNDPROC)
         {
             SetLastError( ERROR_ACCESS_DENIED );
             return 0;
         }
+        if ((offset == GWL_STYLE || offset == GWL_EXSTYLE) && get_window_shm_info( hwnd, &info ))
+            return (offset == GWL_STYLE) ? info.style : info.ex_style;
         SERVER_START_REQ( set_window_info )
         {
             req->handle = wine_server_user_handle( hwnd );
@@ -2939,7 +3085,16 @@ HWND WINAPI GetParent( HWND hwnd )
     if (wndPtr == WND_DESKTOP) return 0;
     if (wndPtr == WND_OTHER_PROCESS)
     {
-        LONG style = GetWindowLongW( hwnd, GWL_STYLE );
+        window_shm_t info;
+        LONG style;
+
+        if (get_window_shm_info( hwnd, &info ))
+        {
+            if (info.style & WS_POPUP) retvalue = wine_server_ptr_handle( info.owner );
+            else if (info.style & WS_CHILD) retvalue = wine_server_ptr_handle( info.parent );
+            return retvalue;
+        }
+        style = GetWindowLongW( hwnd, GWL_STYLE );
         if (style & (WS_POPUP | WS_CHILD))
         {
             SERVER_START_REQ( get_window_tree )
@@ -2971,6 +3126,7 @@ HWND WINAPI GetAncestor( HWND hwnd, UINT type )
 {
     WND *win;
     HWND *list, ret = 0;
+    window_shm_t info;
 
     switch(type)
     {
@@ -2986,6 +3142,10 @@ HWND WINAPI GetAncestor( HWND hwnd, UINT type )
             ret = win->parent;
             WIN_ReleasePtr( win );
         }
+        else if (get_window_shm_info( hwnd, &info ))
+        {
+            ret = wine_server_ptr_handle( info.parent );
+        }
         else /* need to query the server */
         {
             SERVER_START_REQ( get_window_tree )
@@ -3204,6 +3364,7 @@ HWND WINAPI GetTopWindow( HWND hwnd )
 HWND WINAPI GetWindow( HWND hwnd, UINT rel )
 {
     HWND retval = 0;
+    window_shm_t info;
 
     if (rel == GW_OWNER)  /* this one may be available locally */
     {
@@ -3220,6 +3381,7 @@ HWND WINAPI GetWindow( HWND hwnd, UINT rel )
             WIN_ReleasePtr( wndPtr );
             return retval;
         }
+        if (get_window_shm_info( hwnd, &info )) return wine_server_ptr_handle( info.owner );
         /* else fall through to server call */
     }
 
@@ -428,7 +428,12 @@ BOOL WINAPI SetThreadDesktop( HDESK handle )
         struct user_key_state_info *key_state_info = thread_info->key_state;
         thread_info->top_window = 0;
         thread_info->msg_window = 0;
-        if (key_state_info) key_state_info->time = 0;
+        if (key_state_info)
+        {
+            key_state_info->time = 0;
+            if (key_state_info->desktop_shm) UnmapViewOfFile( key_state_info->desktop_shm );
+            key_state_info->desktop_shm = NULL;
+        }
     }
     return ret;
 }
@@ -8168,6 +8168,351 @@ static void shader_glsl_init_uniform_block_bindings(const struct wined3d_gl_info
     string_buffer_release(&priv->string_buffers, name);
 }
 
+/* On-disk cache of linked program binaries, see GL_ARB_get_program_binary.
+ * Entries are named after a hash of the attached shader sources and the
+ * pre-link program state, and are only used when the GL vendor, renderer and
+ * version strings match the ones the binary was created with. */
+#define GLSL_PROGRAM_CACHE_MAGIC    0x50443357u /* "W3DP" */
+#define GLSL_PROGRAM_CACHE_VERSION  1
+
+struct glsl_program_cache_header
+{
+    DWORD magic;
+    DWORD version;
+    UINT64 driver;
+    UINT64 check;
+    UINT64 checksum;
+    DWORD format;
+    DWORD size;
+};
+
+struct glsl_program_cache_key
+{
+    UINT64 name;
+    UINT64 check;
+};
+
+enum glsl_program_cache_state
+{
+    GLSL_PROGRAM_CACHE_UNINITIALIZED,
+    GLSL_PROGRAM_CACHE_READY,
+    GLSL_PROGRAM_CACHE_UNAVAILABLE,
+};
+
+static CRITICAL_SECTION glsl_program_cache_cs;
+static CRITICAL_SECTION_DEBUG glsl_program_cache_cs_debug =
+{
+    0, 0, &glsl_program_cache_cs,
+    {&glsl_program_cache_cs_debug.ProcessLocksList,
+    &glsl_program_cache_cs_debug.ProcessLocksList},
+    0, 0, {(DWORD_PTR)(__FILE__ ": glsl_program_cache_cs")}
+};
+static CRITICAL_SECTION glsl_program_cache_cs = {&glsl_program_cache_cs_debug, -1, 0, 0, 0, 0};
+
+static enum glsl_program_cache_state glsl_program_cache_state;
+static UINT64 glsl_program_cache_used;
+
+static const WCHAR glsl_program_cache_binW[] = {'b','i','n',0};
+static const WCHAR glsl_program_cache_tmpW[] = {'t','m','p',0};
+
+#define GLSL_PROGRAM_CACHE_BASIS    (((UINT64)0xcbf29ce4 << 32) | 0x84222325)
+#define GLSL_PROGRAM_CACHE_PRIME    (((UINT64)0x100 << 32) | 0x000001b3)
+
+static UINT64 glsl_program_cache_hash(UINT64 hash, const void *data, SIZE_T size)
+{
+    const BYTE *ptr = data;
+
+    while (size--)
+    {
+        hash ^= *ptr++;
+        hash *= GLSL_PROGRAM_CACHE_PRIME;
+    }
+
+    return hash;
+}
+
+static UINT64 glsl_program_cache_limit(void)
+{
+    return (UINT64)wined3d_settings.shader_cache_size << 20;
+}
+
+static BOOL glsl_program_cache_get_path(const struct glsl_program_cache_key *key,
+        const WCHAR *extension, WCHAR *path)
+{
+    static const WCHAR fmtW[] = {'%','s','\\','%','0','8','x','%','0','8','x','.','%','s',0};
+
+    if (strlenW(wined3d_settings.shader_cache_dir) + 22 >= MAX_PATH)
+        return FALSE;
+    sprintfW(path, fmtW, wined3d_settings.shader_cache_dir,
+            (DWORD)(key->name >> 32), (DWORD)key->name, extension);
+    return TRUE;
+}
+
+static UINT64 glsl_program_cache_get_file_size(const WCHAR *path)
+{
+    WIN32_FILE_ATTRIBUTE_DATA data;
+
+    if (!GetFileAttributesExW(path, GetFileExInfoStandard, &data))
+        return 0;
+    return ((UINT64)data.nFileSizeHigh << 32) | data.nFileSizeLow;
+}
+
+static void glsl_program_cache_delete(const WCHAR *path)
+{
+    UINT64 size = glsl_program_cache_get_file_size(path);
+
+    EnterCriticalSection(&glsl_program_cache_cs);
+    if (DeleteFileW(path))
+        glsl_program_cache_used -= min(size, glsl_program_cache_used);
+    LeaveCriticalSection(&glsl_program_cache_cs);
+}
+
+static BOOL glsl_program_cache_enabled(const struct wined3d_gl_info *gl_info)
+{
+    static const WCHAR maskW[] = {'%','s','\\','*','.','b','i','n',0};
+    WIN32_FIND_DATAW data;
+    WCHAR path[MAX_PATH];
+    HANDLE find;
+    BOOL ret;
+
+    if (!wined3d_settings.shader_cache_dir || !wined3d_settings.shader_cache_size
+            || !gl_info->supported[ARB_GET_PROGRAM_BINARY])
+        return FALSE;
+
+    EnterCriticalSection(&glsl_program_cache_cs);
+    if (glsl_program_cache_state == GLSL_PROGRAM_CACHE_UNINITIALIZED)
+    {
+        glsl_program_cache_state = GLSL_PROGRAM_CACHE_UNAVAILABLE;
+        if (strlenW(wined3d_settings.shader_cache_dir) + 7 >= MAX_PATH)
+            WARN("Shader cache path %s is too long.\n", debugstr_w(wined3d_settings.shader_cache_dir));
+        else if (!CreateDirectoryW(wined3d_settings.shader_cache_dir, NULL)
+                && GetLastError() != ERROR_ALREADY_EXISTS)
+            WARN("Failed to create shader cache directory %s, error %u.\n",
+                    debugstr_w(wined3d_settings.shader_cache_dir), GetLastError());
+        else
+        {
+            sprintfW(path, maskW, wined3d_settings.shader_cache_dir);
+            if ((find = FindFirstFileW(path, &data)) != INVALID_HANDLE_VALUE)
+            {
+                do
+                {
+                    glsl_program_cache_used += ((UINT64)data.nFileSizeHigh << 32) | data.nFileSizeLow;
+                } while (FindNextFileW(find, &data));
+                FindClose(find);
+            }
+            TRACE("Using shader cache %s, %s bytes used.\n", debugstr_w(wined3d_settings.shader_cache_dir),
+                    wine_dbgstr_longlong(glsl_program_cache_used));
+            glsl_program_cache_state = GLSL_PROGRAM_CACHE_READY;
+        }
+    }
+    ret = glsl_program_cache_state == GLSL_PROGRAM_CACHE_READY;
+    LeaveCriticalSection(&glsl_program_cache_cs);
+
+    return ret;
+}
+
+static UINT64 glsl_program_cache_get_driver_hash(const struct wined3d_gl_info *gl_info)
+{
+    static const GLenum names[] = {GL_VENDOR, GL_RENDERER, GL_VERSION};
+    UINT64 hash = GLSL_PROGRAM_CACHE_BASIS;
+    const char *str;
+    unsigned int i;
+
+    for (i = 0; i < ARRAY_SIZE(names); ++i)
+    {
+        if ((str = (const char *)gl_info->gl_ops.gl.p_glGetString(names[i])))
+            hash = glsl_program_cache_hash(hash, str, strlen(str) + 1);
+    }
+
+    return hash;
+}
+
+/* Context activation is done by the caller. */
+static BOOL glsl_program_cache_get_key(const struct wined3d_gl_info *gl_info, GLuint program_id,
+        const DWORD *params, unsigned int param_count, struct glsl_program_cache_key *key)
+{
+    GLint i, j, shader_count, type, length, source_size = 0;
+    UINT64 (*hashes)[2], tmp[2];
+    char *source = NULL;
+    GLuint *shaders;
+
+    GL_EXTCALL(glGetProgramiv(program_id, GL_ATTACHED_SHADERS, &shader_count));
+    if (!(hashes = wined3d_calloc(shader_count, sizeof(*hashes) + sizeof(*shaders))))
+        return FALSE;
+    shaders = (GLuint *)(hashes + shader_count);
+
+    GL_EXTCALL(glGetAttachedShaders(program_id, shader_count, NULL, shaders));
+    for (i = 0; i < shader_count; ++i)
+    {
+        GL_EXTCALL(glGetShaderiv(shaders[i], GL_SHADER_TYPE, &type));
+        GL_EXTCALL(glGetShaderiv(shaders[i], GL_SHADER_SOURCE_LENGTH, &length));
+
+        if (source_size < length)
+        {
+            HeapFree(GetProcessHeap(), 0, source);
+            if (!(source = HeapAlloc(GetProcessHeap(), 0, length)))
+            {
+                HeapFree(GetProcessHeap(), 0, hashes);
+                return FALSE;
+            }
+            source_size = length;
+        }
+        if (length)
+            GL_EXTCALL(glGetShaderSource(shaders[i], length, NULL, source));
+
+        hashes[i][0] = glsl_program_cache_hash(GLSL_PROGRAM_CACHE_BASIS, &type, sizeof(type));
+        hashes[i][0] = glsl_program_cache_hash(hashes[i][0], source, length);
+        hashes[i][1] = glsl_program_cache_hash(~GLSL_PROGRAM_CACHE_BASIS, &length, sizeof(length));
+        hashes[i][1] = glsl_program_cache_hash(hashes[i][1], source, length);
+    }
+    checkGLcall("get program sources");
+
+    /* glGetAttachedShaders() doesn't return the shaders in any particular
+     * order. */
+    for (i = 1; i < shader_count; ++i)
+    {
+        memcpy(tmp, hashes[i], sizeof(tmp));
+        for (j = i; j > 0 && hashes[j - 1][0] > tmp[0]; --j)
+            memcpy(hashes[j], hashes[j - 1], sizeof(tmp));
+        memcpy(hashes[j], tmp, sizeof(tmp));
+    }
+
+    key->name = GLSL_PROGRAM_CACHE_BASIS;
+    key->check = ~GLSL_PROGRAM_CACHE_BASIS;
+    for (i = 0; i < shader_count; ++i)
+    {
+        key->name = glsl_program_cache_hash(key->name, &hashes[i][0], sizeof(hashes[i][0]));
+        key->check = glsl_program_cache_hash(key->check, &hashes[i][1], sizeof(hashes[i][1]));
+    }
+    key->name = glsl_program_cache_hash(key->name, params, param_count * sizeof(*params));
+    key->check = glsl_program_cache_hash(key->check, params, param_count * sizeof(*params));
+
+    HeapFree(GetProcessHeap(), 0, source);
+    HeapFree(GetProcessHeap(), 0, hashes);
+
+    return TRUE;
+}
+
+/* Context activation is done by the caller. */
+static BOOL glsl_program_cache_load(const struct wined3d_gl_info *gl_info, GLuint program_id,
+        const struct glsl_program_cache_key *key)
+{
+    struct glsl_program_cache_header header;
+    BOOL valid = FALSE, ret = FALSE;
+    WCHAR path[MAX_PATH];
+    void *data = NULL;
+    GLint status;
+    HANDLE file;
+    DWORD count;
+
+    if (!glsl_program_cache_get_path(key, glsl_program_cache_binW, path))
+        return FALSE;
+
+    if ((file = CreateFileW(path, GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE,
+            NULL, OPEN_EXISTING, 0, NULL)) == INVALID_HANDLE_VALUE)
+        return FALSE;
+
+    if (ReadFile(file, &header, sizeof(header), &count, NULL) && count == sizeof(header)
+            && header.magic == GLSL_PROGRAM_CACHE_MAGIC && header.version == GLSL_PROGRAM_CACHE_VERSION
+            && header.check == key->check && header.size && header.size <= glsl_program_cache_limit()
+            && header.driver == glsl_program_cache_get_driver_hash(gl_info)
+            && (data = HeapAlloc(GetProcessHeap(), 0, header.size))
+            && ReadFile(file, data, header.size, &count, NULL) && count == header.size)
+        valid = header.checksum == glsl_program_cache_hash(GLSL_PROGRAM_CACHE_BASIS, data, header.size);
+    CloseHandle(file);
+
+    if (valid)
+    {
+        GL_EXTCALL(glProgramBinary(program_id, header.format, data, header.size));
+        GL_EXTCALL(glGetProgramiv(program_id, GL_LINK_STATUS, &status));
+        checkGLcall("glProgramBinary");
+        if (!(ret = status))
+            WARN("Failed to load cached binary for program %u.\n", program_id);
+    }
+    HeapFree(GetProcessHeap(), 0, data);
+
+    /* Stale or corrupt entries are dropped, they get replaced when the
+     * program is linked again. */
+    if (!ret)
+        glsl_program_cache_delete(path);
+    else
+        TRACE("Loaded program %u from %s.\n", program_id, debugstr_w(path));
+
+    return ret;
+}
+
+/* Context activation is done by the caller. */
+static void glsl_program_cache_store(const struct wined3d_gl_info *gl_info, GLuint program_id,
+        const struct glsl_program_cache_key *key)
+{
+    WCHAR path[MAX_PATH], tmp_path[MAX_PATH];
+    struct glsl_program_cache_header *header;
+    GLint status, size;
+    UINT64 old_size;
+    GLenum format;
+    HANDLE file;
+    DWORD count;
+    BOOL ret;
+
+    GL_EXTCALL(glGetProgramiv(program_id, GL_LINK_STATUS, &status));
+    if (!status)
+        return;
+    GL_EXTCALL(glGetProgramiv(program_id, GL_PROGRAM_BINARY_LENGTH, &size));
+    if (size <= 0 || sizeof(*header) + size > glsl_program_cache_limit())
+        return;
+
+    if (!glsl_program_cache_get_path(key, glsl_program_cache_binW, path)
+            || !glsl_program_cache_get_path(key, glsl_program_cache_tmpW, tmp_path))
+        return;
+
+    if (!(header = HeapAlloc(GetProcessHeap(), 0, sizeof(*header) + size)))
+        return;
+    GL_EXTCALL(glGetProgramBinary(program_id, size, &size, &format, header + 1));
+    checkGLcall("glGetProgramBinary");
+
+    header->magic = GLSL_PROGRAM_CACHE_MAGIC;
+    header->version = GLSL_PROGRAM_CACHE_VERSION;
+    header->driver = glsl_program_cache_get_driver_hash(gl_info);
+    header->check = key->check;
+    header->checksum = glsl_program_cache_hash(GLSL_PROGRAM_CACHE_BASIS, header + 1, size);
+    header->format = format;
+    header->size = size;
+
+    EnterCriticalSection(&glsl_program_cache_cs);
+    old_size = glsl_program_cache_get_file_size(path);
+    if (glsl_program_cache_used - min(old_size, glsl_program_cache_used)
+            + sizeof(*header) + size > glsl_program_cache_limit())
+    {
+        TRACE("Shader cache is full, not storing program %u.\n", program_id);
+        goto done;
+    }
+
+    /* Write to a temporary file first, so that an interrupted write never
+     * leaves a truncated entry behind. */
+    if ((file = CreateFileW(tmp_path, GENERIC_WRITE, 0, NULL, CREATE_ALWAYS, 0, NULL)) == INVALID_HANDLE_VALUE)
+    {
+        WARN("Failed to create %s, error %u.\n", debugstr_w(tmp_path), GetLastError());
+        goto done;
+    }
+    ret = WriteFile(file, header, sizeof(*header) + size, &count, NULL) && count == sizeof(*header) + size;
+    CloseHandle(file);
+
+    if (ret && MoveFileExW(tmp_path, path, MOVEFILE_REPLACE_EXISTING))
+    {
+        glsl_program_cache_used += sizeof(*header) + size - min(old_size, glsl_program_cache_used);
+        TRACE("Stored program %u in %s.\n", program_id, debugstr_w(path));
+    }
+    else
+    {
+        WARN("Failed to write %s, error %u.\n", debugstr_w(path), GetLastError());
+        DeleteFileW(tmp_path);
+    }
+
+done:
+    LeaveCriticalSection(&glsl_program_cache_cs);
+    HeapFree(GetProcessHeap(), 0, header);
+}
+
 /* Context activation is done by the caller. */
 static void set_glsl_shader_program(const struct wined3d_context *context, const struct wined3d_state *state,
         struct shader_glsl_priv *priv, struct glsl_context_data *ctx_data)
@@ -8188,6 +8533,9 @@ static void set_glsl_shader_program(const struct wined3d_context *context, const
     struct list *ps_list, *vs_list;
     WORD attribs_map;
     struct wined3d_string_buffer *tmp_name;
+    struct glsl_program_cache_key cache_key;
+    BOOL use_cache, cached = FALSE;
+    DWORD link_params[5] = {0};
 
     if (!(context->shader_update_mask & (1u << WINED3D_SHADER_TYPE_VERTEX)) && ctx_data->glsl_program)
     {
@@ -8331,6 +8679,8 @@ static void set_glsl_shader_program(const struct wined3d_context *context, const
     {
         attribs_map = (1u << WINED3D_FFP_ATTRIBS_COUNT) - 1;
     }
+    link_params[0] = attribs_map;
+    link_params[1] = shader_glsl_use_explicit_attrib_location(gl_info);
 
     if (!shader_glsl_use_explicit_attrib_location(gl_info))
     {
@@ -8382,6 +8732,9 @@ static void set_glsl_shader_program(const struct wined3d_context *context, const
             GL_EXTCALL(glProgramParameteriARB(program_id, GL_GEOMETRY_VERTICES_OUT_ARB,
                     gshader->u.gs.vertices_out));
             checkGLcall("glProgramParameteriARB");
+            link_params[2] = gshader->u.gs.input_type;
+            link_params[3] = gshader->u.gs.output_type;
+            link_params[4] = gshader->u.gs.vertices_out;
         }
 
         list_add_head(&gshader->linked_programs, &entry->gs.shader_entry);
@@ -8397,10 +8750,21 @@ static void set_glsl_shader_program(const struct wined3d_context *context, const
         list_add_head(ps_list, &entry->ps.shader_entry);
     }
 
+    if ((use_cache = glsl_program_cache_enabled(gl_info)
+            && glsl_program_cache_get_key(gl_info, program_id, link_params, ARRAY_SIZE(link_params), &cache_key)))
+        cached = glsl_program_cache_load(gl_info, program_id, &cache_key);
+
     /* Link the program */
-    TRACE("Linking GLSL shader program %u.\n", program_id);
-    GL_EXTCALL(glLinkProgram(program_id));
-    shader_glsl_validate_link(gl_info, program_id);
+    if (!cached)
+    {
+        TRACE("Linking GLSL shader program %u.\n", program_id);
+        if (use_cache)
+            GL_EXTCALL(glProgramParameteri(program_id, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE));
+        GL_EXTCALL(glLinkProgram(program_id));
+        shader_glsl_validate_link(gl_info, program_id);
+        if (use_cache)
+            glsl_program_cache_store(gl_info, program_id, &cache_key);
+    }
 
     shader_glsl_init_vs_uniform_locations(gl_info, priv, program_id, &entry->vs,
             vshader ? vshader->limits->constant_float : 0);
@@ -557,6 +557,66 @@ ULONG CDECL wined3d_stateblock_decref(struct wined3d_stateblock *stateblock)
     return refcount;
 }
 
+struct wined3d_light_info *wined3d_state_get_light(const struct wined3d_state *state, unsigned int idx)
+{
+    struct wined3d_light_info *light_info;
+    unsigned int hash_idx;
+
+    hash_idx = LIGHTMAP_HASHFUNC(idx);
+    LIST_FOR_EACH_ENTRY(light_info, &state->light_map[hash_idx], struct wined3d_light_info, entry)
+    {
+        if (light_info->OriginalIndex == idx)
+            return light_info;
+    }
+
+    return NULL;
+}
+
+void wined3d_state_enable_light(struct wined3d_state *state, const struct wined3d_d3d_info *d3d_info,
+        struct wined3d_light_info *light_info, BOOL enable)
+{
+    unsigned int light_count, i;
+
+    if (!(light_info->enabled = enable))
+    {
+        if (light_info->glIndex == -1)
+        {
+            TRACE("Light already disabled, nothing to do.\n");
+            return;
+        }
+
+        state->lights[light_info->glIndex] = NULL;
+        light_info->glIndex = -1;
+        return;
+    }
+
+    if (light_info->glIndex != -1)
+    {
+        TRACE("Light already enabled, nothing to do.\n");
+        return;
+    }
+
+    /* Find a free light. */
+    light_count = d3d_info->limits.active_light_count;
+    for (i = 0; i < light_count; ++i)
+    {
+        if (state->lights[i])
+            continue;
+
+        state->lights[i] = light_info;
+        light_info->glIndex = i;
+        return;
+    }
+
+    /* Our tests show that Windows returns D3D_OK in this situation, even with
+     * D3DCREATE_HARDWARE_VERTEXPROCESSING | D3DCREATE_PUREDEVICE devices.
+     * This is consistent among ddraw, d3d8 and d3d9. GetLightEnable returns
+     * TRUE as well for those lights.
+     *
+     * TODO: Test how this affects rendering. */
+    WARN("Too many concurrently active lights.\n");
+}
+
 static void wined3d_state_record_lights(struct wined3d_state *dst_state, const struct wined3d_state *src_state)
 {
     UINT i;
@@ -984,15 +1044,9 @@ void CDECL wined3d_stateblock_apply(const struct wined3d_stateblock *stateblock)
 
     if (stateblock->changed.primitive_type)
     {
-        GLenum gl_primitive_type, prev;
-
         if (device->recording)
             device->recording->changed.primitive_type = TRUE;
-        gl_primitive_type = stateblock->state.gl_primitive_type;
-        prev = device->update_state->gl_primitive_type;
-        device->update_state->gl_primitive_type = gl_primitive_type;
-        if (gl_primitive_type != prev && (gl_primitive_type == GL_POINTS || prev == GL_POINTS))
-            device_invalidate_state(device, STATE_POINT_ENABLE);
+        device->update_state->gl_primitive_type = stateblock->state.gl_primitive_type;
     }
 
     if (stateblock->changed.indices)
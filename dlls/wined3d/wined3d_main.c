@@ -27,6 +27,7 @@
 
 #include "initguid.h"
 #include "wined3d_private.h"
+#include "wine/library.h"
 
 WINE_DEFAULT_DEBUG_CHANNEL(d3d);
 WINE_DECLARE_DEBUG_CHANNEL(winediag);
@@ -90,6 +91,8 @@ struct wined3d_settings wined3d_settings =
     ~0U,            /* No PS shader model limit by default. */
     ~0u,            /* No CS shader model limit by default. */
     FALSE,          /* 3D support enabled by default. */
+    NULL,           /* No on-disk shader cache by default. */
+    64,             /* Shader cache size limit in MiB. */
   FALSE,            /* Override vertex constants? */
   256,             /* Number of vertex shaders to use */
   253,              /* default for UserQuirks */
@@ -140,6 +143,35 @@ static DWORD get_config_key_dword(HKEY defkey, HKEY appkey, const char *name, DW
     return ERROR_FILE_NOT_FOUND;
 }
 
+/* "enabled" selects the default location inside the prefix, anything else is
+ * taken as the path of the cache directory. */
+static WCHAR *get_shader_cache_dir(const char *value)
+{
+    static const char default_dir[] = "/wined3d_cache";
+    const char *config_dir;
+    char *unix_path;
+    WCHAR *path;
+    int len;
+
+    if (strcmp(value, "enabled"))
+    {
+        len = MultiByteToWideChar(CP_ACP, 0, value, -1, NULL, 0);
+        if ((path = HeapAlloc(GetProcessHeap(), 0, len * sizeof(*path))))
+            MultiByteToWideChar(CP_ACP, 0, value, -1, path, len);
+        return path;
+    }
+
+    config_dir = wine_get_config_dir();
+    if (!(unix_path = HeapAlloc(GetProcessHeap(), 0, strlen(config_dir) + sizeof(default_dir))))
+        return NULL;
+    strcpy(unix_path, config_dir);
+    strcat(unix_path, default_dir);
+    path = wine_get_dos_file_name(unix_path);
+    HeapFree(GetProcessHeap(), 0, unix_path);
+
+    return path;
+}
+
 static BOOL wined3d_dll_init(HINSTANCE hInstDLL)
 {
     DWORD wined3d_context_tls_idx;
@@ -365,6 +397,10 @@ static BOOL wined3d_dll_init(HINSTANCE hInstDLL)
             TRACE("Disabling 3D support.\n");
             wined3d_settings.no_3d = TRUE;
         }
+        if (!get_config_key(hkey, appkey, "ShaderCache", buffer, size) && strcmp(buffer, "disabled"))
+            wined3d_settings.shader_cache_dir = get_shader_cache_dir(buffer);
+        if (!get_config_key_dword(hkey, appkey, "ShaderCacheSize", &wined3d_settings.shader_cache_size))
+            TRACE("Limiting the shader cache to %u MiB.\n", wined3d_settings.shader_cache_size);
     }
 
     if (appkey) RegCloseKey( appkey );
@@ -397,6 +433,7 @@ static BOOL wined3d_dll_destroy(HINSTANCE hInstDLL)
     HeapFree(GetProcessHeap(), 0, wndproc_table.entries);
 
     HeapFree(GetProcessHeap(), 0, wined3d_settings.logo);
+    HeapFree(GetProcessHeap(), 0, wined3d_settings.shader_cache_dir);
     UnregisterClassA(WINED3D_OPENGL_WINDOW_CLASS_NAME, hInstDLL);
 
     DeleteCriticalSection(&wined3d_wndproc_cs);
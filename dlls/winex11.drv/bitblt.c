@@ -1568,6 +1568,8 @@ struct x11drv_window_surface
     COLORREF              color_key;
     HRGN                  region;
     void                 *bits;
+    void                 *shadow;        /* copy of the bits at the last flush */
+    BOOL                  shadow_valid;  /* whether the shadow matches the window contents */
 #ifdef HAVE_LIBXXSHM
     XShmSegmentInfo       shminfo;
 #endif
@@ -1882,14 +1884,122 @@ static void x11drv_surface_set_region( struct window_surface *window_surface, HR
     window_surface->funcs->unlock( window_surface );
 }
 
+/* size of the tiles compared against the shadow copy when flushing */
+#define SURFACE_TILE_SIZE 64
+
+/***********************************************************************
+ *           convert_surface_rows
+ *
+ * Convert a range of rows of the surface bits to the X image format.
+ */
+static void convert_surface_rows( struct x11drv_window_surface *surface, int top, int bottom )
+{
+    const int *mapping = NULL;
+    int width_bytes = surface->image->bytes_per_line;
+    unsigned char *src = surface->bits;
+    unsigned char *dst = (unsigned char *)surface->image->data;
+
+    if (src == dst) return;
+
+    if (surface->image->bits_per_pixel == 4 || surface->image->bits_per_pixel == 8)
+        mapping = X11DRV_PALETTE_PaletteToXPixel;
+
+    src += top * width_bytes;
+    dst += top * width_bytes;
+    copy_image_byteswap( &surface->info, src, dst, width_bytes, width_bytes,
+                         bottom - top, surface->byteswap, mapping, ~0u );
+}
+
+/***********************************************************************
+ *           put_surface_rect
+ *
+ * Upload a rectangle of the X image to the window.
+ */
+static void put_surface_rect( struct x11drv_window_surface *surface, const RECT *rect )
+{
+#ifdef HAVE_LIBXXSHM
+    if (surface->shminfo.shmid != -1)
+        XShmPutImage( gdi_display, surface->window, surface->gc, surface->image,
+                      rect->left, rect->top,
+                      surface->header.rect.left + rect->left,
+                      surface->header.rect.top + rect->top,
+                      rect->right - rect->left, rect->bottom - rect->top, False );
+    else
+#endif
+    XPutImage( gdi_display, surface->window, surface->gc, surface->image,
+               rect->left, rect->top,
+               surface->header.rect.left + rect->left,
+               surface->header.rect.top + rect->top,
+               rect->right - rect->left, rect->bottom - rect->top );
+}
+
+/***********************************************************************
+ *           update_surface_shadow
+ *
+ * Compare a rectangle of the surface bits with the shadow copy, and update
+ * the shadow copy if it changed. Returns TRUE if the rectangle changed.
+ */
+static BOOL update_surface_shadow( struct x11drv_window_surface *surface, const RECT *rect, BOOL force )
+{
+    int bpp = surface->info.bmiHeader.biBitCount;
+    int width_bytes = surface->image->bytes_per_line;
+    int start = rect->left * bpp / 8, end = (rect->right * bpp + 7) / 8;
+    int y;
+    unsigned char *src = (unsigned char *)surface->bits + rect->top * width_bytes;
+    unsigned char *dst = (unsigned char *)surface->shadow + rect->top * width_bytes;
+
+    if (!force)
+    {
+        for (y = rect->top; y < rect->bottom; y++, src += width_bytes, dst += width_bytes)
+            if (memcmp( src + start, dst + start, end - start )) break;
+        if (y == rect->bottom) return FALSE;
+    }
+    for (y = rect->top; y < rect->bottom; y++, src += width_bytes, dst += width_bytes)
+        memcpy( dst + start, src + start, end - start );
+    return TRUE;
+}
+
+/***********************************************************************
+ *           flush_surface_tiles
+ *
+ * Upload only the tiles of a rectangle that changed since the last flush.
+ */
+static void flush_surface_tiles( struct x11drv_window_surface *surface, const RECT *rect )
+{
+    RECT tile, run;
+    BOOL converted;
+
+    for (tile.top = rect->top; tile.top < rect->bottom; tile.top = tile.bottom)
+    {
+        tile.bottom = min( (tile.top / SURFACE_TILE_SIZE + 1) * SURFACE_TILE_SIZE, rect->bottom );
+        converted = FALSE;
+        SetRectEmpty( &run );
+
+        for (tile.left = rect->left; tile.left < rect->right; tile.left = tile.right)
+        {
+            tile.right = min( (tile.left / SURFACE_TILE_SIZE + 1) * SURFACE_TILE_SIZE, rect->right );
+            if (update_surface_shadow( surface, &tile, FALSE ))
+            {
+                /* merge adjacent changed tiles into a single upload */
+                if (IsRectEmpty( &run )) run = tile;
+                else run.right = tile.right;
+                if (tile.right < rect->right) continue;
+            }
+            if (IsRectEmpty( &run )) continue;
+            if (!converted) convert_surface_rows( surface, tile.top, tile.bottom );
+            converted = TRUE;
+            put_surface_rect( surface, &run );
+            SetRectEmpty( &run );
+        }
+    }
+}
+
 /***********************************************************************
  *           x11drv_surface_flush
  */
 static void x11drv_surface_flush( struct window_surface *window_surface )
 {
     struct x11drv_window_surface *surface = get_x11_surface( window_surface );
-    unsigned char *src = surface->bits;
-    unsigned char *dst = (unsigned char *)surface->image->data;
     struct bitblt_coords coords;
 
     window_surface->funcs->lock( window_surface );
@@ -1906,37 +2016,22 @@ static void x11drv_surface_flush( struct window_surface *window_surface )
 
         if (surface->is_argb || surface->color_key != CLR_INVALID) update_surface_region( surface );
 
-        if (src != dst)
+        if (surface->shadow && surface->shadow_valid)
         {
-            const int *mapping = NULL;
-            int width_bytes = surface->image->bytes_per_line;
-
-            if (surface->image->bits_per_pixel == 4 || surface->image->bits_per_pixel == 8)
-                mapping = X11DRV_PALETTE_PaletteToXPixel;
-
-            src += coords.visrect.top * width_bytes;
-            dst += coords.visrect.top * width_bytes;
-            copy_image_byteswap( &surface->info, src, dst, width_bytes, width_bytes,
-                                 coords.visrect.bottom - coords.visrect.top,
-                                 surface->byteswap, mapping, ~0u );
+            flush_surface_tiles( surface, &coords.visrect );
         }
-
-#ifdef HAVE_LIBXXSHM
-        if (surface->shminfo.shmid != -1)
-            XShmPutImage( gdi_display, surface->window, surface->gc, surface->image,
-                          coords.visrect.left, coords.visrect.top,
-                          surface->header.rect.left + coords.visrect.left,
-                          surface->header.rect.top + coords.visrect.top,
-                          coords.visrect.right - coords.visrect.left,
-                          coords.visrect.bottom - coords.visrect.top, False );
         else
-#endif
-        XPutImage( gdi_display, surface->window, surface->gc, surface->image,
-                   coords.visrect.left, coords.visrect.top,
-                   surface->header.rect.left + coords.visrect.left,
-                   surface->header.rect.top + coords.visrect.top,
-                   coords.visrect.right - coords.visrect.left,
-                   coords.visrect.bottom - coords.visrect.top );
+        {
+            /* upload everything once so that the shadow matches the window contents */
+            if (surface->shadow) SetRect( &coords.visrect, 0, 0, coords.width, coords.height );
+            convert_surface_rows( surface, coords.visrect.top, coords.visrect.bottom );
+            put_surface_rect( surface, &coords.visrect );
+            if (surface->shadow)
+            {
+                update_surface_shadow( surface, &coords.visrect, TRUE );
+                surface->shadow_valid = TRUE;
+            }
+        }
         XFlush( gdi_display );
     }
     reset_bounds( &surface->bounds );
@@ -1952,6 +2047,7 @@ static void x11drv_surface_destroy( struct window_surface *window_surface )
 
     TRACE( "freeing %p bits %p\n", surface, surface->bits );
     if (surface->gc) XFreeGC( gdi_display, surface->gc );
+    HeapFree( GetProcessHeap(), 0, surface->shadow );
     if (surface->image)
     {
         if (surface->image->data != surface->bits) HeapFree( GetProcessHeap(), 0, surface->bits );
@@ -2042,6 +2138,9 @@ struct window_surface *create_surface( Window window, const XVisualInfo *vis, co
     }
     else surface->bits = surface->image->data;
 
+    /* the shadow copy is only used to reduce uploads, so failing to allocate it is not fatal */
+    surface->shadow = HeapAlloc( GetProcessHeap(), 0, surface->info.bmiHeader.biSizeImage );
+
     TRACE( "created %p for %lx %s bits %p-%p image %p\n", surface, window, wine_dbgstr_rect(rect),
            surface->bits, (char *)surface->bits + surface->info.bmiHeader.biSizeImage,
            surface->image->data );
@@ -2082,6 +2181,7 @@ HRGN expose_surface( struct window_surface *window_surface, const RECT *rect )
 
     window_surface->funcs->lock( window_surface );
     add_bounds_rect( &surface->bounds, rect );
+    surface->shadow_valid = FALSE;  /* the window contents need to be uploaded again */
     if (surface->region)
     {
         region = CreateRectRgnIndirect( rect );
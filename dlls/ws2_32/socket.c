@@ -64,6 +64,9 @@
 #ifdef HAVE_SYS_UIO_H
 # include <sys/uio.h>
 #endif
+#ifdef HAVE_SYS_SENDFILE_H
+# include <sys/sendfile.h>
+#endif
 #ifdef HAVE_SYS_SOCKET_H
 #include <sys/socket.h>
 #endif
@@ -529,6 +532,7 @@ struct ws2_transmitfile_async
     TRANSMIT_FILE_BUFFERS buffers;
     DWORD                 flags;
     LARGE_INTEGER         offset;
+    BOOL                  use_sendfile;
     struct ws2_async      write;
 };
 
@@ -587,6 +591,7 @@ struct per_thread_data
     struct WS_servent *se_buffer;
     struct WS_protoent *pe_buffer;
     struct pollfd *fd_cache;
+    BYTE *fd_checked;  /* whether the fd_cache entry has been checked, see check_poll_results */
     unsigned int fd_count;
     int he_len;
     int se_len;
@@ -614,7 +619,8 @@ static int ws_protocol_info(SOCKET s, int unicode, WSAPROTOCOL_INFOW *buffer, in
 int WSAIOCTL_GetInterfaceCount(void);
 int WSAIOCTL_GetInterfaceName(int intNumber, char *intName);
 
-static void WS_AddCompletion( SOCKET sock, ULONG_PTR CompletionValue, NTSTATUS CompletionStatus, ULONG Information );
+static void WS_AddCompletion( SOCKET sock, ULONG_PTR CompletionValue, NTSTATUS CompletionStatus,
+                              ULONG Information, HANDLE event );
 
 #define MAP_OPTION(opt) { WS_##opt, opt }
 
@@ -2435,7 +2441,8 @@ static NTSTATUS WS2_async_accept_recv( void *user, IO_STATUS_BLOCK *iosb,
         return status;
 
     if (wsa->cvalue)
-        WS_AddCompletion( HANDLE2SOCKET(wsa->listen_socket), wsa->cvalue, iosb->u.Status, iosb->Information );
+        WS_AddCompletion( HANDLE2SOCKET(wsa->listen_socket), wsa->cvalue, iosb->u.Status,
+                          iosb->Information, 0 );
 
     release_async_io( &wsa->io );
     return status;
@@ -3008,6 +3015,66 @@ static NTSTATUS WS2_transmitfile_getbuffer( int fd, struct ws2_transmitfile_asyn
     return STATUS_SUCCESS;
 }
 
+#ifdef HAVE_SYS_SENDFILE_H
+/***********************************************************************
+ *     WS2_transmitfile_sendfile        (INTERNAL)
+ *
+ * Send the main file directly from its unix fd, without copying it through a
+ * user-space buffer. Returns STATUS_SUCCESS once the whole file has been sent,
+ * and STATUS_NOT_SUPPORTED if the copy loop has to be used instead.
+ */
+static NTSTATUS WS2_transmitfile_sendfile( int fd, struct ws2_transmitfile_async *wsa )
+{
+    IO_STATUS_BLOCK *iosb = (IO_STATUS_BLOCK *)wsa->write.user_overlapped;
+    HANDLE file = wsa->file;
+    NTSTATUS status = STATUS_PENDING;
+    off_t offset, *poffset = NULL;
+    size_t count;
+    ssize_t ret;
+    int file_fd;
+
+    if (wine_server_handle_to_fd( file, FILE_READ_DATA, &file_fd, NULL ))
+    {
+        wsa->use_sendfile = FALSE;
+        return STATUS_NOT_SUPPORTED;
+    }
+    if (wsa->offset.QuadPart != FILE_USE_FILE_POINTER_POSITION)
+    {
+        offset = wsa->offset.QuadPart;
+        poffset = &offset;
+    }
+
+    while (status == STATUS_PENDING)
+    {
+        count = wsa->file_bytes ? wsa->file_bytes - wsa->file_read : 0x7ffff000;
+        if ((ret = sendfile( fd, file_fd, poffset, count )) == -1)
+        {
+            if (errno == EINTR) continue;
+            if (errno == EAGAIN) break;
+            if (errno == EINVAL || errno == ENOSYS)
+            {
+                /* not supported for this file or socket, nothing was sent */
+                wsa->use_sendfile = FALSE;
+                status = STATUS_NOT_SUPPORTED;
+            }
+            else status = wsaErrStatus();
+            break;
+        }
+        if (poffset) wsa->offset.QuadPart = offset;
+        if (iosb) iosb->Information += ret;
+        wsa->file_read += ret;
+        if (!ret || (wsa->file_bytes && wsa->file_read >= wsa->file_bytes))
+        {
+            wsa->file = NULL;  /* continue on to the footer */
+            status = STATUS_SUCCESS;
+        }
+    }
+
+    wine_server_release_fd( file, file_fd );
+    return status;
+}
+#endif
+
 /***********************************************************************
  *     WS2_transmitfile_base            (INTERNAL)
  *
@@ -3017,6 +3084,16 @@ static NTSTATUS WS2_transmitfile_base( int fd, struct ws2_transmitfile_async *ws
 {
     NTSTATUS status;
 
+#ifdef HAVE_SYS_SENDFILE_H
+    /* once the header is out, send the file without copying it */
+    if (wsa->use_sendfile && wsa->file && !wsa->buffers.Head &&
+        wsa->write.first_iovec >= wsa->write.n_iovecs)
+    {
+        status = WS2_transmitfile_sendfile( fd, wsa );
+        if (status != STATUS_SUCCESS && status != STATUS_NOT_SUPPORTED) return status;
+    }
+#endif
+
     status = WS2_transmitfile_getbuffer( fd, wsa );
     if (status == STATUS_PENDING)
     {
@@ -3122,6 +3199,7 @@ static BOOL WINAPI WS2_TransmitFile( SOCKET s, HANDLE h, DWORD file_bytes, DWORD
     wsa->bytes_per_send        = bytes_per_send;
     wsa->flags                 = flags;
     wsa->offset.QuadPart       = FILE_USE_FILE_POINTER_POSITION;
+    wsa->use_sendfile          = TRUE;
     wsa->write.hSocket         = SOCKET2HANDLE(s);
     wsa->write.addr            = NULL;
     wsa->write.addrlen.val     = 0;
@@ -5111,8 +5189,8 @@ INT WINAPI WSAIoctl(SOCKET s, DWORD code, LPVOID in_buff, DWORD in_size, LPVOID
         ULONG_PTR cvalue = (overlapped && ((ULONG_PTR)overlapped->hEvent & 1) == 0) ? (ULONG_PTR)overlapped : 0;
         overlapped->Internal = status;
         overlapped->InternalHigh = total;
-        if (overlapped->hEvent) NtSetEvent( overlapped->hEvent, NULL );
-        if (cvalue) WS_AddCompletion( HANDLE2SOCKET(s), cvalue, status, total );
+        if (cvalue) WS_AddCompletion( HANDLE2SOCKET(s), cvalue, status, total, overlapped->hEvent );
+        else if (overlapped->hEvent) NtSetEvent( overlapped->hEvent, NULL );
     }
 
     if (!status)
@@ -5202,6 +5280,7 @@ int WINAPI WS_recvfrom(SOCKET s, char *buf, INT len, int flags,
 }
 
 /* allocate a poll array for the corresponding fd sets */
+/* the sockets are not checked for being bound until they get an event, see check_poll_results */
 static struct pollfd *fd_sets_to_poll( const WS_fd_set *readfds, const WS_fd_set *writefds,
                                        const WS_fd_set *exceptfds, int *count_ptr )
 {
@@ -5222,17 +5301,19 @@ static struct pollfd *fd_sets_to_poll( const WS_fd_set *readfds, const WS_fd_set
     /* check if the cache can hold all descriptors, if not do the resizing */
     if (ptb->fd_count < count)
     {
-        if (!(fds = HeapAlloc(GetProcessHeap(), 0, count * sizeof(fds[0]))))
+        if (!(fds = HeapAlloc(GetProcessHeap(), 0, count * (sizeof(fds[0]) + sizeof(BYTE)))))
         {
             SetLastError( ERROR_NOT_ENOUGH_MEMORY );
             return NULL;
         }
         HeapFree(GetProcessHeap(), 0, ptb->fd_cache);
         ptb->fd_cache = fds;
+        ptb->fd_checked = (BYTE *)(fds + count);
         ptb->fd_count = count;
     }
     else
         fds = ptb->fd_cache;
+    memset( ptb->fd_checked, 0, count );
 
     if (readfds)
         for (i = 0; i < readfds->fd_count; i++, j++)
@@ -5240,16 +5321,7 @@ static struct pollfd *fd_sets_to_poll( const WS_fd_set *readfds, const WS_fd_set
             fds[j].fd = get_sock_fd( readfds->fd_array[i], FILE_READ_DATA, NULL );
             if (fds[j].fd == -1) goto failed;
             fds[j].revents = 0;
-            if (is_fd_bound(fds[j].fd, NULL, NULL) == 1)
-            {
-                fds[j].events = POLLIN;
-            }
-            else
-            {
-                release_sock_fd( readfds->fd_array[i], fds[j].fd );
-                fds[j].fd = -1;
-                fds[j].events = 0;
-            }
+            fds[j].events = POLLIN;
         }
     if (writefds)
         for (i = 0; i < writefds->fd_count; i++, j++)
@@ -5257,17 +5329,7 @@ static struct pollfd *fd_sets_to_poll( const WS_fd_set *readfds, const WS_fd_set
             fds[j].fd = get_sock_fd( writefds->fd_array[i], FILE_WRITE_DATA, NULL );
             if (fds[j].fd == -1) goto failed;
             fds[j].revents = 0;
-            if (is_fd_bound(fds[j].fd, NULL, NULL) == 1 ||
-                _get_fd_type(fds[j].fd) == SOCK_DGRAM)
-            {
-                fds[j].events = POLLOUT;
-            }
-            else
-            {
-                release_sock_fd( writefds->fd_array[i], fds[j].fd );
-                fds[j].fd = -1;
-                fds[j].events = 0;
-            }
+            fds[j].events = POLLOUT;
         }
     if (exceptfds)
         for (i = 0; i < exceptfds->fd_count; i++, j++)
@@ -5275,24 +5337,7 @@ static struct pollfd *fd_sets_to_poll( const WS_fd_set *readfds, const WS_fd_set
             fds[j].fd = get_sock_fd( exceptfds->fd_array[i], 0, NULL );
             if (fds[j].fd == -1) goto failed;
             fds[j].revents = 0;
-            if (is_fd_bound(fds[j].fd, NULL, NULL) == 1)
-            {
-                int oob_inlined = 0;
-                socklen_t olen = sizeof(oob_inlined);
-
-                fds[j].events = POLLHUP;
-
-                /* Check if we need to test for urgent data or not */
-                getsockopt(fds[j].fd, SOL_SOCKET, SO_OOBINLINE, (char*) &oob_inlined, &olen);
-                if (!oob_inlined)
-                    fds[j].events |= POLLPRI;
-            }
-            else
-            {
-                release_sock_fd( exceptfds->fd_array[i], fds[j].fd );
-                fds[j].fd = -1;
-                fds[j].events = 0;
-            }
+            fds[j].events = POLLHUP | POLLPRI;
         }
     return fds;
 
@@ -5311,6 +5356,64 @@ failed:
     return NULL;
 }
 
+/* check whether a socket that got an event should have been polled at all */
+/* returns FALSE if it has to be removed from the poll array */
+static BOOL check_poll_fd( struct pollfd *fd, short events )
+{
+    if (is_fd_bound( fd->fd, NULL, NULL ) != 1)
+        return events == POLLOUT && _get_fd_type( fd->fd ) == SOCK_DGRAM;
+
+    if (events & POLLPRI)
+    {
+        int oob_inlined = 0;
+        socklen_t olen = sizeof(oob_inlined);
+
+        /* Check if we need to test for urgent data or not */
+        getsockopt( fd->fd, SOL_SOCKET, SO_OOBINLINE, (char*) &oob_inlined, &olen );
+        if (oob_inlined)
+        {
+            fd->events &= ~POLLPRI;
+            fd->revents &= ~POLLPRI;
+        }
+    }
+    return TRUE;
+}
+
+/* check the sockets that got events in the last poll, the first time they get one */
+/* returns TRUE if only unwanted events were reported and the poll has to be restarted */
+static BOOL check_poll_results( const WS_fd_set *readfds, const WS_fd_set *writefds,
+                                const WS_fd_set *exceptfds, struct pollfd *fds )
+{
+    const WS_fd_set *sets[3] = { readfds, writefds, exceptfds };
+    static const short events[3] = { POLLIN, POLLOUT, POLLHUP | POLLPRI };
+    BYTE *checked = get_per_thread_data()->fd_checked;
+    unsigned int i, j = 0, k;
+    BOOL valid = FALSE;
+
+    for (k = 0; k < 3; k++)
+    {
+        if (!sets[k]) continue;
+        for (i = 0; i < sets[k]->fd_count; i++, j++)
+        {
+            if (fds[j].fd == -1 || !fds[j].revents) continue;
+            if (!checked[j])
+            {
+                checked[j] = 1;
+                if (!check_poll_fd( &fds[j], events[k] ))
+                {
+                    release_sock_fd( sets[k]->fd_array[i], fds[j].fd );
+                    fds[j].fd = -1;
+                    fds[j].events = fds[j].revents = 0;
+                    continue;
+                }
+                if (!fds[j].revents) continue;
+            }
+            valid = TRUE;
+        }
+    }
+    return !valid;
+}
+
 /* release the file descriptor obtained in fd_sets_to_poll */
 /* must be called with the original fd_set arrays, before calling get_poll_results */
 static void release_poll_fds( const WS_fd_set *readfds, const WS_fd_set *writefds,
@@ -5425,6 +5528,7 @@ int WINAPI WS_select(int nfds, WS_fd_set *ws_readfds,
 {
     struct pollfd *pollfds;
     int count, ret, timeout = -1;
+    DWORD start = 0;
 
     TRACE("read %p, write %p, excp %p timeout %p\n",
           ws_readfds, ws_writefds, ws_exceptfds, ws_timeout);
@@ -5433,9 +5537,21 @@ int WINAPI WS_select(int nfds, WS_fd_set *ws_readfds,
         return SOCKET_ERROR;
 
     if (ws_timeout)
+    {
         timeout = (ws_timeout->tv_sec * 1000) + (ws_timeout->tv_usec + 999) / 1000;
+        start = GetTickCount();
+    }
 
-    ret = do_poll(pollfds, count, timeout);
+    while ((ret = do_poll( pollfds, count, timeout )) > 0 &&
+           check_poll_results( ws_readfds, ws_writefds, ws_exceptfds, pollfds ))
+    {
+        if (timeout > 0)
+        {
+            int elapsed = GetTickCount() - start;
+            start += elapsed;
+            timeout = max( timeout - elapsed, 0 );
+        }
+    }
     release_poll_fds( ws_readfds, ws_writefds, ws_exceptfds, pollfds );
 
     if (ret == -1) SetLastError(wsaErrno());
@@ -5505,9 +5621,10 @@ int WINAPI WSAPoll(WSAPOLLFD *wfds, ULONG count, int timeout)
     return ret;
 }
 
-/* helper to send completion messages for client-only i/o operation case */
+/* helper to send completion messages for client-only i/o operation case,
+ * the event, if any, is signaled in the same server call */
 static void WS_AddCompletion( SOCKET sock, ULONG_PTR CompletionValue, NTSTATUS CompletionStatus,
-                              ULONG Information )
+                              ULONG Information, HANDLE event )
 {
     SERVER_START_REQ( add_fd_completion )
     {
@@ -5515,6 +5632,7 @@ static void WS_AddCompletion( SOCKET sock, ULONG_PTR CompletionValue, NTSTATUS C
         req->cvalue      = CompletionValue;
         req->status      = CompletionStatus;
         req->information = Information;
+        req->event       = wine_server_obj_handle( event );
         wine_server_call( req );
     }
     SERVER_END_REQ;
@@ -5664,8 +5782,8 @@ static int WS2_sendto( SOCKET s, LPWSABUF lpBuffers, DWORD dwBufferCount,
         if (lpNumberOfBytesSent) *lpNumberOfBytesSent = n;
         if (!wsa->completion_func)
         {
-            if (cvalue) WS_AddCompletion( s, cvalue, STATUS_SUCCESS, n );
-            if (lpOverlapped->hEvent) SetEvent( lpOverlapped->hEvent );
+            if (cvalue) WS_AddCompletion( s, cvalue, STATUS_SUCCESS, n, lpOverlapped->hEvent );
+            else if (lpOverlapped->hEvent) SetEvent( lpOverlapped->hEvent );
             HeapFree( GetProcessHeap(), 0, wsa );
         }
         else NtQueueApcThread( GetCurrentThread(), (PNTAPCFUNC)ws2_async_apc,
@@ -7801,7 +7919,7 @@ static int WS2_recv_base( SOCKET s, LPWSABUF lpBuffers, DWORD dwBufferCount,
             {
                 int loc_errno = errno;
                 err = wsaErrno();
-                if (cvalue) WS_AddCompletion( s, cvalue, sock_get_ntstatus(loc_errno), 0 );
+                if (cvalue) WS_AddCompletion( s, cvalue, sock_get_ntstatus(loc_errno), 0, 0 );
                 goto error;
             }
         }
@@ -7842,8 +7960,8 @@ static int WS2_recv_base( SOCKET s, LPWSABUF lpBuffers, DWORD dwBufferCount,
             iosb->Information = n;
             if (!wsa->completion_func)
             {
-                if (cvalue) WS_AddCompletion( s, cvalue, STATUS_SUCCESS, n );
-                if (lpOverlapped->hEvent) SetEvent( lpOverlapped->hEvent );
+                if (cvalue) WS_AddCompletion( s, cvalue, STATUS_SUCCESS, n, lpOverlapped->hEvent );
+                else if (lpOverlapped->hEvent) SetEvent( lpOverlapped->hEvent );
                 HeapFree( GetProcessHeap(), 0, wsa );
             }
             else NtQueueApcThread( GetCurrentThread(), (PNTAPCFUNC)ws2_async_apc,
@@ -346,6 +346,53 @@ typedef struct
 } char_info_t;
 
 
+typedef struct
+{
+    unsigned int   wake_bits;
+    unsigned int   changed_bits;
+} queue_shm_t;
+
+
+typedef struct
+{
+    unsigned int   seq;
+    user_handle_t  handle;
+    user_handle_t  parent;
+    user_handle_t  owner;
+    unsigned int   style;
+    unsigned int   ex_style;
+    rectangle_t    window;
+    rectangle_t    client;
+} window_shm_t;
+
+
+typedef struct
+{
+    unsigned int   seq;
+    int            cursor_x;
+    int            cursor_y;
+    unsigned int   cursor_change;
+    unsigned char  keystate[256];
+} desktop_shm_t;
+
+
+typedef struct
+{
+    unsigned int   value;
+    unsigned int   max;
+    unsigned int   type;
+    unsigned int   id;
+    int            waiters;
+} fast_sync_shm_t;
+
+#define FAST_SYNC_MANUAL_EVENT 1
+#define FAST_SYNC_AUTO_EVENT   2
+#define FAST_SYNC_SEMAPHORE    3
+
+
+#define FAST_SYNC_LOCKED       0x80000000
+
+
 struct filesystem_event
 {
     int         action;
@@ -1184,13 +1231,15 @@ struct create_event_request
     unsigned int access;
     int          manual_reset;
     int          initial_state;
+    int          fast_sync;
     /* VARARG(objattr,object_attributes); */
+    char __pad_28[4];
 };
 struct create_event_reply
 {
     struct reply_header __header;
     obj_handle_t handle;
-    char __pad_12[4];
+    int          fast_sync;
 };
 
 
@@ -1338,13 +1387,15 @@ struct create_semaphore_request
     unsigned int access;
     unsigned int initial;
     unsigned int max;
+    int          fast_sync;
     /* VARARG(objattr,object_attributes); */
+    char __pad_28[4];
 };
 struct create_semaphore_reply
 {
     struct reply_header __header;
     obj_handle_t handle;
-    char __pad_12[4];
+    int          fast_sync;
 };
 
 
@@ -1393,6 +1444,32 @@ struct open_semaphore_reply
 
 
 
+struct get_fast_sync_shm_request
+{
+    struct request_header __header;
+    char __pad_12[4];
+};
+struct get_fast_sync_shm_reply
+{
+    struct reply_header __header;
+    obj_handle_t handle;
+    char __pad_12[4];
+};
+
+
+
+struct fast_sync_wake_request
+{
+    struct request_header __header;
+    obj_handle_t handle;
+};
+struct fast_sync_wake_reply
+{
+    struct reply_header __header;
+};
+
+
+
 struct create_file_request
 {
     struct request_header __header;
@@ -2898,7 +2975,7 @@ struct get_msg_queue_reply
 {
     struct reply_header __header;
     obj_handle_t handle;
-    char __pad_12[4];
+    obj_handle_t shm_mapping;
 };
 
 
@@ -3620,6 +3697,20 @@ enum coords_relative
 
 
 
+struct get_window_shm_request
+{
+    struct request_header __header;
+    char __pad_12[4];
+};
+struct get_window_shm_reply
+{
+    struct reply_header __header;
+    obj_handle_t   handle;
+    char __pad_12[4];
+};
+
+
+
 struct get_window_text_request
 {
     struct request_header __header;
@@ -4167,6 +4258,19 @@ struct get_key_state_reply
 };
 
 
+struct get_desktop_shm_request
+{
+    struct request_header __header;
+    char __pad_12[4];
+};
+struct get_desktop_shm_reply
+{
+    struct reply_header __header;
+    obj_handle_t   handle;
+    char __pad_12[4];
+};
+
+
 struct set_key_state_request
 {
     struct request_header __header;
@@ -5240,6 +5344,28 @@ struct remove_completion_reply
 };
 
 
+struct completion_info
+{
+    apc_param_t   ckey;
+    apc_param_t   cvalue;
+    apc_param_t   information;
+    unsigned int  status;
+    unsigned int  __pad;
+};
+
+
+struct remove_completions_request
+{
+    struct request_header __header;
+    obj_handle_t handle;
+};
+struct remove_completions_reply
+{
+    struct reply_header __header;
+    /* VARARG(packets,completion_infos); */
+};
+
+
 
 struct query_completion_request
 {
@@ -5277,7 +5403,7 @@ struct add_fd_completion_request
     apc_param_t    cvalue;
     apc_param_t    information;
     unsigned int   status;
-    char __pad_36[4];
+    obj_handle_t   event;
 };
 struct add_fd_completion_reply
 {
@@ -5589,6 +5715,8 @@ enum request
     REQ_release_semaphore,
     REQ_query_semaphore,
     REQ_open_semaphore,
+    REQ_get_fast_sync_shm,
+    REQ_fast_sync_wake,
     REQ_create_file,
     REQ_open_file_object,
     REQ_alloc_file_handle,
@@ -5714,6 +5842,7 @@ enum request
     REQ_get_window_tree,
     REQ_set_window_pos,
     REQ_get_window_rectangles,
+    REQ_get_window_shm,
     REQ_get_window_text,
     REQ_set_window_text,
     REQ_get_windows_offset,
@@ -5748,6 +5877,7 @@ enum request
     REQ_get_thread_input,
     REQ_get_last_input_time,
     REQ_get_key_state,
+    REQ_get_desktop_shm,
     REQ_set_key_state,
     REQ_set_foreground_window,
     REQ_set_focus_window,
@@ -5812,6 +5942,7 @@ enum request
     REQ_open_completion,
     REQ_add_completion,
     REQ_remove_completion,
+    REQ_remove_completions,
     REQ_query_completion,
     REQ_set_completion_info,
     REQ_add_fd_completion,
@@ -5879,6 +6010,8 @@ union generic_request
     struct release_semaphore_request release_semaphore_request;
     struct query_semaphore_request query_semaphore_request;
     struct open_semaphore_request open_semaphore_request;
+    struct get_fast_sync_shm_request get_fast_sync_shm_request;
+    struct fast_sync_wake_request fast_sync_wake_request;
     struct create_file_request create_file_request;
     struct open_file_object_request open_file_object_request;
     struct alloc_file_handle_request alloc_file_handle_request;
@@ -6004,6 +6137,7 @@ union generic_request
     struct get_window_tree_request get_window_tree_request;
     struct set_window_pos_request set_window_pos_request;
     struct get_window_rectangles_request get_window_rectangles_request;
+    struct get_window_shm_request get_window_shm_request;
     struct get_window_text_request get_window_text_request;
     struct set_window_text_request set_window_text_request;
     struct get_windows_offset_request get_windows_offset_request;
@@ -6038,6 +6172,7 @@ union generic_request
     struct get_thread_input_request get_thread_input_request;
     struct get_last_input_time_request get_last_input_time_request;
     struct get_key_state_request get_key_state_request;
+    struct get_desktop_shm_request get_desktop_shm_request;
     struct set_key_state_request set_key_state_request;
     struct set_foreground_window_request set_foreground_window_request;
     struct set_focus_window_request set_focus_window_request;
@@ -6102,6 +6237,7 @@ union generic_request
     struct open_completion_request open_completion_request;
     struct add_completion_request add_completion_request;
     struct remove_completion_request remove_completion_request;
+    struct remove_completions_request remove_completions_request;
     struct query_completion_request query_completion_request;
     struct set_completion_info_request set_completion_info_request;
     struct add_fd_completion_request add_fd_completion_request;
@@ -6167,6 +6303,8 @@ union generic_reply
     struct release_semaphore_reply release_semaphore_reply;
     struct query_semaphore_reply query_semaphore_reply;
     struct open_semaphore_reply open_semaphore_reply;
+    struct get_fast_sync_shm_reply get_fast_sync_shm_reply;
+    struct fast_sync_wake_reply fast_sync_wake_reply;
     struct create_file_reply create_file_reply;
     struct open_file_object_reply open_file_object_reply;
     struct alloc_file_handle_reply alloc_file_handle_reply;
@@ -6292,6 +6430,7 @@ union generic_reply
     struct get_window_tree_reply get_window_tree_reply;
     struct set_window_pos_reply set_window_pos_reply;
     struct get_window_rectangles_reply get_window_rectangles_reply;
+    struct get_window_shm_reply get_window_shm_reply;
     struct get_window_text_reply get_window_text_reply;
     struct set_window_text_reply set_window_text_reply;
     struct get_windows_offset_reply get_windows_offset_reply;
@@ -6326,6 +6465,7 @@ union generic_reply
     struct get_thread_input_reply get_thread_input_reply;
     struct get_last_input_time_reply get_last_input_time_reply;
     struct get_key_state_reply get_key_state_reply;
+    struct get_desktop_shm_reply get_desktop_shm_reply;
     struct set_key_state_reply set_key_state_reply;
     struct set_foreground_window_reply set_foreground_window_reply;
     struct set_focus_window_reply set_focus_window_reply;
@@ -6390,6 +6530,7 @@ union generic_reply
     struct open_completion_reply open_completion_reply;
     struct add_completion_reply add_completion_reply;
     struct remove_completion_reply remove_completion_reply;
+    struct remove_completions_reply remove_completions_reply;
     struct query_completion_reply query_completion_reply;
     struct set_completion_info_reply set_completion_info_reply;
     struct add_fd_completion_reply add_fd_completion_reply;
@@ -6412,6 +6553,6 @@ union generic_reply
     struct terminate_job_reply terminate_job_reply;
 };
 
-#define SERVER_PROTOCOL_VERSION 524
+#define SERVER_PROTOCOL_VERSION 530
 
 #endif /* __WINE_WINE_SERVER_PROTOCOL_H */
@@ -2355,6 +2355,19 @@ extern struct _TEB * WINAPI NtCurrentTeb(void);
 #endif
 #define GetFiberData()     (*(void **)GetCurrentFiber())
 
+#ifdef __GNUC__
+static FORCEINLINE void YieldProcessor(void)
+{
+#if defined(__i386__) || defined(__x86_64__)
+    __asm__ __volatile__( "rep; nop" : : : "memory" );
+#elif defined(__arm__) || defined(__aarch64__)
+    __asm__ __volatile__( "yield" : : : "memory" );
+#else
+    __asm__ __volatile__( "" : : : "memory" );
+#endif
+}
+#endif
+
 #define TLS_MINIMUM_AVAILABLE 64
 
 /*
@@ -31,6 +31,7 @@
 #include "windef.h"
 #include "winternl.h"
 
+#include "file.h"
 #include "handle.h"
 #include "thread.h"
 #include "request.h"
@@ -41,22 +42,26 @@ struct event
     struct object  obj;             /* object header */
     int            manual_reset;    /* is it a manual reset event? */
     int            signaled;        /* event has been signaled */
+    int            fast_sync;       /* index of the state shared with the clients, or -1 */
 };
 
 static void event_dump( struct object *obj, int verbose );
 static struct object_type *event_get_type( struct object *obj );
+static int event_add_queue( struct object *obj, struct wait_queue_entry *entry );
+static void event_remove_queue( struct object *obj, struct wait_queue_entry *entry );
 static int event_signaled( struct object *obj, struct wait_queue_entry *entry );
 static void event_satisfied( struct object *obj, struct wait_queue_entry *entry );
 static unsigned int event_map_access( struct object *obj, unsigned int access );
 static int event_signal( struct object *obj, unsigned int access);
+static void event_destroy( struct object *obj );
 
 static const struct object_ops event_ops =
 {
     sizeof(struct event),      /* size */
     event_dump,                /* dump */
     event_get_type,            /* get_type */
-    add_queue,                 /* add_queue */
-    remove_queue,              /* remove_queue */
+    event_add_queue,           /* add_queue */
+    event_remove_queue,        /* remove_queue */
     event_signaled,            /* signaled */
     event_satisfied,           /* satisfied */
     event_signal,              /* signal */
@@ -69,7 +74,7 @@ static const struct object_ops event_ops =
     default_unlink_name,       /* unlink_name */
     no_open_file,              /* open_file */
     no_close_handle,           /* close_handle */
-    no_destroy                 /* destroy */
+    event_destroy              /* destroy */
 };
 
 
@@ -106,6 +111,139 @@ static const struct object_ops keyed_event_ops =
 };
 
 
+/* state of events and semaphores shared with the clients */
+
+#define FAST_SYNC_COUNT 16384
+
+static struct object *fast_sync_mapping;           /* mapping of the shared state */
+static volatile fast_sync_shm_t *fast_sync_shm;    /* shared state entries */
+static int fast_sync_free[FAST_SYNC_COUNT];        /* stack of freed entries */
+static int fast_sync_free_count;
+static int fast_sync_used;                         /* number of entries ever allocated */
+static unsigned int fast_sync_last_id;             /* last id given to an entry */
+static int fast_sync_locked[MAXIMUM_WAIT_OBJECTS]; /* entries locked by the current wait check */
+static int fast_sync_locked_count;
+
+static struct object *get_fast_sync_mapping(void)
+{
+    void *ptr;
+
+    if (!fast_sync_mapping &&
+        (fast_sync_mapping = create_shared_mapping( FAST_SYNC_COUNT * sizeof(fast_sync_shm_t), &ptr )))
+    {
+        make_object_static( fast_sync_mapping );
+        fast_sync_shm = ptr;
+    }
+    return fast_sync_mapping;
+}
+
+/* allocate a shared state entry, returns -1 if none is available */
+int alloc_fast_sync( unsigned int type, unsigned int value, unsigned int max )
+{
+    volatile fast_sync_shm_t *shm;
+    int index;
+
+    if (!get_fast_sync_mapping())
+    {
+        clear_error();
+        return -1;
+    }
+    if (fast_sync_free_count) index = fast_sync_free[--fast_sync_free_count];
+    else if (fast_sync_used < FAST_SYNC_COUNT) index = fast_sync_used++;
+    else return -1;
+
+    shm = &fast_sync_shm[index];
+    shm->value   = value;
+    shm->max     = max;
+    shm->waiters = 0;
+    if (!++fast_sync_last_id) ++fast_sync_last_id;
+    shm->id      = fast_sync_last_id;
+    shm->type    = type;
+    return index;
+}
+
+void free_fast_sync( int index )
+{
+    fast_sync_shm[index].type = 0;
+    fast_sync_shm[index].id = 0;
+    fast_sync_free[fast_sync_free_count++] = index;
+}
+
+unsigned int get_fast_sync_value( int index )
+{
+    return fast_sync_shm[index].value & ~FAST_SYNC_LOCKED;
+}
+
+/* change the shared value, keeping the lock bit; returns the previous value */
+unsigned int set_fast_sync_value( int index, unsigned int value )
+{
+    volatile fast_sync_shm_t *shm = &fast_sync_shm[index];
+    unsigned int old;
+
+    do old = shm->value;
+    while (__sync_val_compare_and_swap( &shm->value, old, value | (old & FAST_SYNC_LOCKED) ) != old);
+    return old & ~FAST_SYNC_LOCKED;
+}
+
+/* add to the shared value without exceeding max; returns 0 if it would */
+int add_fast_sync_value( int index, unsigned int count, unsigned int max, unsigned int *prev )
+{
+    volatile fast_sync_shm_t *shm = &fast_sync_shm[index];
+    unsigned int old, value;
+
+    do
+    {
+        old = shm->value;
+        value = old & ~FAST_SYNC_LOCKED;
+        *prev = value;
+        if (value + count < value || value + count > max) return 0;
+    }
+    while (__sync_val_compare_and_swap( &shm->value, old, (value + count) | (old & FAST_SYNC_LOCKED) ) != old);
+    return 1;
+}
+
+/* the clients only set the value when nobody waits in the server, or wake them afterwards */
+void add_fast_sync_waiter( int index, int count )
+{
+    __sync_fetch_and_add( &fast_sync_shm[index].waiters, count );
+}
+
+/* prevent the clients from changing the value until unlock_fast_sync is called;
+ * this keeps the state checked by signaled() valid until satisfied() */
+unsigned int lock_fast_sync( int index )
+{
+    unsigned int old = __sync_fetch_and_or( &fast_sync_shm[index].value, FAST_SYNC_LOCKED );
+
+    if (!(old & FAST_SYNC_LOCKED))
+    {
+        assert( fast_sync_locked_count < MAXIMUM_WAIT_OBJECTS );
+        fast_sync_locked[fast_sync_locked_count++] = index;
+    }
+    return old & ~FAST_SYNC_LOCKED;
+}
+
+/* unlock the entries locked while checking a wait */
+void unlock_fast_sync(void)
+{
+    while (fast_sync_locked_count)
+    {
+        int index = fast_sync_locked[--fast_sync_locked_count];
+        __sync_fetch_and_and( &fast_sync_shm[index].value, ~FAST_SYNC_LOCKED );
+    }
+}
+
+static int get_event_state( struct event *event )
+{
+    if (event->fast_sync != -1) return get_fast_sync_value( event->fast_sync );
+    return event->signaled;
+}
+
+static void set_event_state( struct event *event, int state )
+{
+    if (event->fast_sync != -1) set_fast_sync_value( event->fast_sync, state );
+    else event->signaled = state;
+}
+
 struct event *create_event( struct object *root, const struct unicode_str *name,
                             unsigned int attr, int manual_reset, int initial_state,
                             const struct security_descriptor *sd )
@@ -119,6 +257,7 @@ struct event *create_event( struct object *root, const struct unicode_str *name,
             /* initialize it if it didn't already exist */
             event->manual_reset = manual_reset;
             event->signaled     = initial_state;
+            event->fast_sync    = -1;
         }
     }
     return event;
@@ -131,22 +270,22 @@ struct event *get_event_obj( struct process *process, obj_handle_t handle, unsig
 
 void pulse_event( struct event *event )
 {
-    event->signaled = 1;
+    set_event_state( event, 1 );
     /* wake up all waiters if manual reset, a single one otherwise */
     wake_up( &event->obj, !event->manual_reset );
-    event->signaled = 0;
+    set_event_state( event, 0 );
 }
 
 void set_event( struct event *event )
 {
-    event->signaled = 1;
+    set_event_state( event, 1 );
     /* wake up all waiters if manual reset, a single one otherwise */
     wake_up( &event->obj, !event->manual_reset );
 }
 
 void reset_event( struct event *event )
 {
-    event->signaled = 0;
+    set_event_state( event, 0 );
 }
 
 static void event_dump( struct object *obj, int verbose )
@@ -154,7 +293,7 @@ static void event_dump( struct object *obj, int verbose )
     struct event *event = (struct event *)obj;
     assert( obj->ops == &event_ops );
     fprintf( stderr, "Event manual=%d signaled=%d\n",
-             event->manual_reset, event->signaled );
+             event->manual_reset, get_event_state( event ) );
 }
 
 static struct object_type *event_get_type( struct object *obj )
@@ -164,10 +303,27 @@ static struct object_type *event_get_type( struct object *obj )
     return get_object_type( &str );
 }
 
+static int event_add_queue( struct object *obj, struct wait_queue_entry *entry )
+{
+    struct event *event = (struct event *)obj;
+    assert( obj->ops == &event_ops );
+    if (event->fast_sync != -1) add_fast_sync_waiter( event->fast_sync, 1 );
+    return add_queue( obj, entry );
+}
+
+static void event_remove_queue( struct object *obj, struct wait_queue_entry *entry )
+{
+    struct event *event = (struct event *)obj;
+    assert( obj->ops == &event_ops );
+    if (event->fast_sync != -1) add_fast_sync_waiter( event->fast_sync, -1 );
+    remove_queue( obj, entry );
+}
+
 static int event_signaled( struct object *obj, struct wait_queue_entry *entry )
 {
     struct event *event = (struct event *)obj;
     assert( obj->ops == &event_ops );
+    if (event->fast_sync != -1) return lock_fast_sync( event->fast_sync ) != 0;
     return event->signaled;
 }
 
@@ -176,7 +332,7 @@ static void event_satisfied( struct object *obj, struct wait_queue_entry *entry
     struct event *event = (struct event *)obj;
     assert( obj->ops == &event_ops );
     /* Reset if it's an auto-reset event */
-    if (!event->manual_reset) event->signaled = 0;
+    if (!event->manual_reset) set_event_state( event, 0 );
 }
 
 static unsigned int event_map_access( struct object *obj, unsigned int access )
@@ -202,6 +358,13 @@ static int event_signal( struct object *obj, unsigned int access )
     return 1;
 }
 
+static void event_destroy( struct object *obj )
+{
+    struct event *event = (struct event *)obj;
+    assert( obj->ops == &event_ops );
+    if (event->fast_sync != -1) free_fast_sync( event->fast_sync );
+}
+
 struct keyed_event *create_keyed_event( struct object *root, const struct unicode_str *name,
                                         unsigned int attr, const struct security_descriptor *sd )
 {
@@ -288,8 +451,15 @@ DECL_HANDLER(create_event)
         if (get_error() == STATUS_OBJECT_NAME_EXISTS)
             reply->handle = alloc_handle( current->process, event, req->access, objattr->attributes );
         else
+        {
+            if (req->fast_sync)
+                event->fast_sync = alloc_fast_sync( event->manual_reset ? FAST_SYNC_MANUAL_EVENT
+                                                                        : FAST_SYNC_AUTO_EVENT,
+                                                    event->signaled, 1 );
             reply->handle = alloc_handle_no_access_check( current->process, event,
                                                           req->access, objattr->attributes );
+        }
+        reply->fast_sync = event->fast_sync;
         release_object( event );
     }
 
@@ -337,7 +507,7 @@ DECL_HANDLER(query_event)
     if (!(event = get_event_obj( current->process, req->handle, EVENT_QUERY_STATE ))) return;
 
     reply->manual_reset = event->manual_reset;
-    reply->state = event->signaled;
+    reply->state = get_event_state( event );
 
     release_object( event );
 }
@@ -373,3 +543,22 @@ DECL_HANDLER(open_keyed_event)
     reply->handle = open_object( current->process, req->rootdir, req->access,
                                  &keyed_event_ops, &name, req->attributes );
 }
+
+/* get the mapping of the event and semaphore state shared with the clients */
+DECL_HANDLER(get_fast_sync_shm)
+{
+    struct object *mapping;
+
+    if ((mapping = get_fast_sync_mapping()))
+        reply->handle = alloc_handle( current->process, mapping, SECTION_MAP_READ | SECTION_MAP_WRITE, 0 );
+}
+
+/* wake up the waiters of an object whose shared state was changed by a client */
+DECL_HANDLER(fast_sync_wake)
+{
+    struct object *obj;
+
+    if (!(obj = get_handle_obj( current->process, req->handle, 0, NULL ))) return;
+    wake_up( obj, 0 );
+    release_object( obj );
+}
@@ -358,13 +358,19 @@ static file_pos_t max_unix_offset = OFF_T_MAX;
 
 struct timeout_user
 {
-    struct list           entry;      /* entry in sorted timeout list */
+    struct list           entry;      /* entry in expired list while callbacks are running */
+    unsigned int          index;      /* index in timeout heap, or EXPIRED_TIMEOUT */
     timeout_t             when;       /* timeout expiry (absolute time) */
     timeout_callback      callback;   /* callback function */
     void                 *private;    /* callback private data */
 };
 
-static struct list timeout_list = LIST_INIT(timeout_list);   /* sorted timeouts list */
+#define EXPIRED_TIMEOUT (~0u)
+
+/* pending timeouts are kept in a binary min-heap ordered by expiry time */
+static struct timeout_user **timeout_heap;   /* heap array */
+static unsigned int timeout_count;           /* number of entries in the heap */
+static unsigned int timeout_size;            /* allocated size of the heap array */
 timeout_t current_time;
 
 static inline void set_current_time(void)
@@ -375,32 +381,90 @@ static inline void set_current_time(void)
     current_time = (timeout_t)now.tv_sec * TICKS_PER_SEC + now.tv_usec * 10 + ticks_1601_to_1970;
 }
 
+static inline void set_heap_entry( unsigned int index, struct timeout_user *user )
+{
+    timeout_heap[index] = user;
+    user->index = index;
+}
+
+/* move a heap entry towards the root until the heap property holds */
+static void timeout_heap_up( unsigned int index, struct timeout_user *user )
+{
+    while (index)
+    {
+        unsigned int parent = (index - 1) / 2;
+        if (timeout_heap[parent]->when <= user->when) break;
+        set_heap_entry( index, timeout_heap[parent] );
+        index = parent;
+    }
+    set_heap_entry( index, user );
+}
+
+/* move a heap entry towards the leaves until the heap property holds */
+static void timeout_heap_down( unsigned int index, struct timeout_user *user )
+{
+    for (;;)
+    {
+        unsigned int child = 2 * index + 1;
+        if (child >= timeout_count) break;
+        if (child + 1 < timeout_count && timeout_heap[child + 1]->when < timeout_heap[child]->when)
+            child++;
+        if (user->when <= timeout_heap[child]->when) break;
+        set_heap_entry( index, timeout_heap[child] );
+        index = child;
+    }
+    set_heap_entry( index, user );
+}
+
+/* remove an entry from the timeout heap */
+static void timeout_heap_remove( struct timeout_user *user )
+{
+    unsigned int index = user->index;
+    struct timeout_user *last = timeout_heap[--timeout_count];
+
+    user->index = EXPIRED_TIMEOUT;
+    if (last == user) return;
+    if (index && timeout_heap[(index - 1) / 2]->when > last->when)
+        timeout_heap_up( index, last );
+    else
+        timeout_heap_down( index, last );
+}
+
 /* add a timeout user */
 struct timeout_user *add_timeout_user( timeout_t when, timeout_callback func, void *private )
 {
     struct timeout_user *user;
-    struct list *ptr;
+
+    if (timeout_count == timeout_size)
+    {
+        struct timeout_user **new_heap;
+        unsigned int new_size = timeout_size ? timeout_size * 2 : 64;
+
+        if (!(new_heap = realloc( timeout_heap, new_size * sizeof(*timeout_heap) )))
+        {
+            set_error( STATUS_NO_MEMORY );
+            return NULL;
+        }
+        timeout_heap = new_heap;
+        timeout_size = new_size;
+    }
 
     if (!(user = mem_alloc( sizeof(*user) ))) return NULL;
     user->when     = (when > 0) ? when : current_time - when;
     user->callback = func;
     user->private  = private;
 
-    /* Now insert it in the linked list */
-
-    LIST_FOR_EACH( ptr, &timeout_list )
-    {
-        struct timeout_user *timeout = LIST_ENTRY( ptr, struct timeout_user, entry );
-        if (timeout->when >= user->when) break;
-    }
-    list_add_before( ptr, &user->entry );
+    timeout_heap_up( timeout_count++, user );
     return user;
 }
 
 /* remove a timeout user */
 void remove_timeout_user( struct timeout_user *user )
 {
-    list_remove( &user->entry );
+    if (user->index == EXPIRED_TIMEOUT)
+        list_remove( &user->entry );
+    else
+        timeout_heap_remove( user );
     free( user );
 }
 
@@ -461,48 +525,110 @@ static inline void fd_poll_event( struct fd *fd, int event )
 
 static int epoll_fd = -1;
 
+/* epoll state of a poll user */
+struct epoll_user
+{
+    int events;   /* events currently registered with epoll */
+    int pending;  /* user is in the pending list */
+};
+
+static struct epoll_user *epoll_users;      /* epoll state array, indexed like pollfd */
+static int *epoll_pending;                  /* users whose registered events need to be updated */
+static int nb_epoll_pending;                /* count of entries in the pending array */
+static int allocated_epoll_users;           /* count of allocated entries in the arrays */
+
 static inline void init_epoll(void)
 {
     epoll_fd = epoll_create( 128 );
 }
 
-/* set the events that epoll waits for on this fd; helper for set_fd_events */
-static inline void set_fd_epoll_events( struct fd *fd, int user, int events )
+/* give up on epoll after a fatal error */
+static void disable_epoll(void)
+{
+    close( epoll_fd );
+    epoll_fd = -1;
+}
+
+/* make sure the epoll state arrays can hold the given user */
+static int grow_epoll_users( int user )
+{
+    struct epoll_user *new_users;
+    int *new_pending;
+
+    if (user < allocated_epoll_users) return 1;
+    if (!(new_users = realloc( epoll_users, allocated_users * sizeof(*epoll_users) ))) return 0;
+    epoll_users = new_users;
+    if (!(new_pending = realloc( epoll_pending, allocated_users * sizeof(*epoll_pending) ))) return 0;
+    epoll_pending = new_pending;
+    memset( epoll_users + allocated_epoll_users, 0,
+            (allocated_users - allocated_epoll_users) * sizeof(*epoll_users) );
+    allocated_epoll_users = allocated_users;
+    return 1;
+}
+
+static inline void do_epoll_ctl( int ctl, int user, int unix_fd, int events )
 {
     struct epoll_event ev;
-    int ctl;
 
+    ev.events = events;
+    memset(&ev.data, 0, sizeof(ev.data));
+    ev.data.u32 = user;
+
+    if (epoll_ctl( epoll_fd, ctl, unix_fd, &ev ) == -1)
+    {
+        if (errno == ENOMEM)  /* not enough memory, give up on epoll */
+            disable_epoll();
+        else perror( "epoll_ctl" );  /* should not happen */
+    }
+    else epoll_users[user].events = events;
+}
+
+/* set the events that epoll waits for on this fd; helper for set_fd_events */
+static inline void set_fd_epoll_events( struct fd *fd, int user, int events )
+{
     if (epoll_fd == -1) return;
 
     if (events == -1)  /* stop waiting on this fd completely */
     {
         if (pollfd[user].fd == -1) return;  /* already removed */
-        ctl = EPOLL_CTL_DEL;
+        do_epoll_ctl( EPOLL_CTL_DEL, user, fd->unix_fd, 0 );
     }
     else if (pollfd[user].fd == -1)
     {
         if (pollfd[user].events) return;  /* stopped waiting on it, don't restart */
-        ctl = EPOLL_CTL_ADD;
+        if (!grow_epoll_users( user ))
+        {
+            disable_epoll();
+            return;
+        }
+        do_epoll_ctl( EPOLL_CTL_ADD, user, fd->unix_fd, events );
     }
     else
     {
-        if (pollfd[user].events == events) return;  /* nothing to do */
-        ctl = EPOLL_CTL_MOD;
+        /* the event mask of an fd often changes several times while processing a request,
+         * so only update it once before waiting again, see flush_epoll_events */
+        if (epoll_users[user].pending) return;
+        if (epoll_users[user].events == events) return;  /* nothing to do */
+        epoll_users[user].pending = 1;
+        epoll_pending[nb_epoll_pending++] = user;
     }
+}
 
-    ev.events = events;
-    memset(&ev.data, 0, sizeof(ev.data));
-    ev.data.u32 = user;
+/* update the registered events of the users that changed since the last wait */
+static void flush_epoll_events(void)
+{
+    int i, user;
 
-    if (epoll_ctl( epoll_fd, ctl, fd->unix_fd, &ev ) == -1)
+    for (i = 0; i < nb_epoll_pending; i++)
     {
-        if (errno == ENOMEM)  /* not enough memory, give up on epoll */
-        {
-            close( epoll_fd );
-            epoll_fd = -1;
-        }
-        else perror( "epoll_ctl" );  /* should not happen */
+        user = epoll_pending[i];
+        epoll_users[user].pending = 0;
+        if (epoll_fd == -1) continue;
+        if (pollfd[user].fd == -1) continue;  /* removed in the meantime */
+        if (epoll_users[user].events == pollfd[user].events) continue;  /* changed back */
+        do_epoll_ctl( EPOLL_CTL_MOD, user, pollfd[user].fd, pollfd[user].events );
     }
+    nb_epoll_pending = 0;
 }
 
 static inline void remove_epoll_user( struct fd *fd, int user )
@@ -533,6 +659,7 @@ static inline void main_loop_epoll(void)
         timeout = get_next_timeout();
 
         if (!active_users) break;  /* last user removed by a timeout */
+        flush_epoll_events();
         if (epoll_fd == -1) break;  /* an error occurred with epoll */
 
         ret = epoll_wait( epoll_fd, events, sizeof(events)/sizeof(events[0]), timeout );
@@ -846,23 +973,18 @@ static void remove_poll_user( struct fd *fd, int user )
 /* process pending timeouts and return the time until the next timeout, in milliseconds */
 static int get_next_timeout(void)
 {
-    if (!list_empty( &timeout_list ))
+    if (timeout_count)
     {
         struct list expired_list, *ptr;
 
-        /* first remove all expired timers from the list */
+        /* first remove all expired timers from the heap */
 
         list_init( &expired_list );
-        while ((ptr = list_head( &timeout_list )) != NULL)
+        while (timeout_count && timeout_heap[0]->when <= current_time)
         {
-            struct timeout_user *timeout = LIST_ENTRY( ptr, struct timeout_user, entry );
-
-            if (timeout->when <= current_time)
-            {
-                list_remove( &timeout->entry );
-                list_add_tail( &expired_list, &timeout->entry );
-            }
-            else break;
+            struct timeout_user *timeout = timeout_heap[0];
+            timeout_heap_remove( timeout );
+            list_add_tail( &expired_list, &timeout->entry );
         }
 
         /* now call the callback for all the removed timers */
@@ -875,10 +997,9 @@ static int get_next_timeout(void)
             free( timeout );
         }
 
-        if ((ptr = list_head( &timeout_list )) != NULL)
+        if (timeout_count)
         {
-            struct timeout_user *timeout = LIST_ENTRY( ptr, struct timeout_user, entry );
-            int diff = (timeout->when - current_time + 9999) / 10000;
+            int diff = (timeout_heap[0]->when - current_time + 9999) / 10000;
             if (diff < 0) diff = 0;
             return diff;
         }
@@ -2536,7 +2657,20 @@ DECL_HANDLER(set_completion_info)
 /* push new completion msg into a completion queue attached to the fd */
 DECL_HANDLER(add_fd_completion)
 {
-    struct fd *fd = get_handle_fd_obj( current->process, req->handle, 0 );
+    struct fd *fd;
+
+    if (req->event)
+    {
+        struct event *event = get_event_obj( current->process, req->event, EVENT_MODIFY_STATE );
+        if (event)
+        {
+            set_event( event );
+            release_object( event );
+        }
+        clear_error();
+    }
+
+    fd = get_handle_fd_obj( current->process, req->handle, 0 );
     if (fd)
     {
         if (fd->completion)
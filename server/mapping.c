@@ -689,6 +689,28 @@ int get_page_size(void)
     return page_mask + 1;
 }
 
+/* create an anonymous mapping that is also mapped into the server address space */
+struct object *create_shared_mapping( mem_size_t size, void **ptr )
+{
+    struct mapping *mapping;
+    int unix_fd;
+
+    if (!(mapping = (struct mapping *)create_mapping( NULL, NULL, 0, size, SEC_COMMIT,
+                                                      VPROT_READ | VPROT_WRITE, 0, NULL )))
+        return NULL;
+    if ((unix_fd = get_unix_fd( mapping->fd )) == -1) goto error;
+    if ((*ptr = mmap( NULL, mapping->size, PROT_READ | PROT_WRITE, MAP_SHARED, unix_fd, 0 )) == MAP_FAILED)
+    {
+        file_set_error();
+        goto error;
+    }
+    return &mapping->obj;
+
+ error:
+    release_object( mapping );
+    return NULL;
+}
+
 /* create a file mapping */
 DECL_HANDLER(create_mapping)
 {
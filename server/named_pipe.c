@@ -75,6 +75,7 @@ struct pipe_server
     struct pipe_client  *client;     /* client that this server is connected to */
     struct named_pipe   *pipe;
     struct timeout_user *flush_poll;
+    timeout_t            flush_interval; /* current flush polling interval */
     unsigned int         options;    /* pipe options */
     unsigned int         pipe_flags;
 };
@@ -530,13 +531,20 @@ static int pipe_data_remaining( struct pipe_server *server )
     return pfd.revents&POLLIN;
 }
 
+/* flush polling starts short and backs off, so that a reader that drains the
+ * pipe promptly doesn't leave the writer waiting for a full polling period */
+#define FLUSH_POLL_MIN (TICKS_PER_SEC / 1000)
+#define FLUSH_POLL_MAX (TICKS_PER_SEC / 10)
+
 static void check_flushed( void *arg )
 {
     struct pipe_server *server = (struct pipe_server*) arg;
 
     if (pipe_data_remaining( server ))
     {
-        server->flush_poll = add_timeout_user( -TICKS_PER_SEC / 10, check_flushed, server );
+        if (server->flush_interval < FLUSH_POLL_MAX / 2) server->flush_interval *= 2;
+        else server->flush_interval = FLUSH_POLL_MAX;
+        server->flush_poll = add_timeout_user( -server->flush_interval, check_flushed, server );
     }
     else
     {
@@ -559,7 +567,10 @@ static obj_handle_t pipe_server_flush( struct fd *fd, const async_data_t *async_
     {
         /* there's no unix way to be alerted when a pipe becomes empty, so resort to polling */
         if (!server->flush_poll)
-            server->flush_poll = add_timeout_user( -TICKS_PER_SEC / 10, check_flushed, server );
+        {
+            server->flush_interval = FLUSH_POLL_MIN;
+            server->flush_poll = add_timeout_user( -server->flush_interval, check_flushed, server );
+        }
         if (blocking) handle = alloc_handle( current->process, async, SYNCHRONIZE, 0 );
         release_object( async );
         set_error( STATUS_PENDING );
@@ -680,6 +691,7 @@ static struct pipe_server *create_pipe_server( struct named_pipe *pipe, unsigned
     server->pipe = pipe;
     server->client = NULL;
     server->flush_poll = NULL;
+    server->flush_interval = FLUSH_POLL_MIN;
     server->options = options;
     server->pipe_flags = pipe_flags;
 
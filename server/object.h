@@ -185,6 +185,14 @@ extern struct keyed_event *get_keyed_event_obj( struct process *process, obj_han
 extern void pulse_event( struct event *event );
 extern void set_event( struct event *event );
 extern void reset_event( struct event *event );
+extern int alloc_fast_sync( unsigned int type, unsigned int value, unsigned int max );
+extern void free_fast_sync( int index );
+extern unsigned int get_fast_sync_value( int index );
+extern unsigned int set_fast_sync_value( int index, unsigned int value );
+extern int add_fast_sync_value( int index, unsigned int count, unsigned int max, unsigned int *prev );
+extern void add_fast_sync_waiter( int index, int count );
+extern unsigned int lock_fast_sync( int index );
+extern void unlock_fast_sync(void);
 
 /* mutex functions */
 
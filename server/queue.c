@@ -25,6 +25,9 @@
 #include <stdarg.h>
 #include <stdio.h>
 #include <stdlib.h>
+#ifdef HAVE_SYS_MMAN_H
+# include <sys/mman.h>
+#endif
 #ifdef HAVE_POLL_H
 # include <poll.h>
 #endif
@@ -140,6 +143,8 @@ struct msg_queue
     struct thread_input   *input;           /* thread input descriptor */
     struct hook_table     *hooks;           /* hook table */
     timeout_t              last_get_msg;    /* time of last get message call */
+    struct object         *shm_mapping;     /* mapping of the state shared with the client */
+    volatile queue_shm_t  *shm;             /* state shared with the client */
 };
 
 struct hotkey
@@ -298,6 +303,8 @@ static struct msg_queue *create_msg_queue( struct thread *thread, struct thread_
         queue->input           = (struct thread_input *)grab_object( input );
         queue->hooks           = NULL;
         queue->last_get_msg    = current_time;
+        queue->shm_mapping     = NULL;
+        queue->shm             = NULL;
         list_init( &queue->send_result );
         list_init( &queue->callback_result );
         list_init( &queue->pending_timers );
@@ -339,6 +346,32 @@ static int assign_thread_input( struct thread *thread, struct thread_input *new_
     return 1;
 }
 
+/* update the input state shared with the clients */
+static void update_desktop_shm( struct desktop *desktop )
+{
+    volatile desktop_shm_t *shm = desktop->shm;
+
+    if (!shm) return;
+    shm->seq++;
+    __sync_synchronize();
+    shm->cursor_x = desktop->cursor.x;
+    shm->cursor_y = desktop->cursor.y;
+    shm->cursor_change = desktop->cursor.last_change;
+    memcpy( (void *)shm->keystate, desktop->keystate, sizeof(desktop->keystate) );
+    __sync_synchronize();
+    shm->seq++;
+}
+
+/* free the input state shared with the clients */
+void free_desktop_shm( struct desktop *desktop )
+{
+    if (!desktop->shm_mapping) return;
+    munmap( (void *)desktop->shm, sizeof(*desktop->shm) );
+    release_object( desktop->shm_mapping );
+    desktop->shm_mapping = NULL;
+    desktop->shm = NULL;
+}
+
 /* set the cursor position and queue the corresponding mouse message */
 static void set_cursor_pos( struct desktop *desktop, int x, int y )
 {
@@ -435,11 +468,20 @@ static inline int is_signaled( struct msg_queue *queue )
     return ((queue->wake_bits & queue->wake_mask) || (queue->changed_bits & queue->changed_mask));
 }
 
+/* update the queue state shared with the client */
+static inline void update_queue_shm( struct msg_queue *queue )
+{
+    if (!queue->shm) return;
+    queue->shm->wake_bits    = queue->wake_bits;
+    queue->shm->changed_bits = queue->changed_bits;
+}
+
 /* set some queue bits */
 static inline void set_queue_bits( struct msg_queue *queue, unsigned int bits )
 {
     queue->wake_bits |= bits;
     queue->changed_bits |= bits;
+    update_queue_shm( queue );
     if (is_signaled( queue )) wake_up( &queue->obj, 0 );
 }
 
@@ -448,6 +490,7 @@ static inline void clear_queue_bits( struct msg_queue *queue, unsigned int bits
 {
     queue->wake_bits &= ~bits;
     queue->changed_bits &= ~bits;
+    update_queue_shm( queue );
 }
 
 /* check whether msg is a keyboard message */
@@ -995,6 +1038,8 @@ static void msg_queue_destroy( struct object *obj )
     release_object( queue->input );
     if (queue->hooks) release_object( queue->hooks );
     if (queue->fd) release_object( queue->fd );
+    if (queue->shm) munmap( (void *)queue->shm, get_page_size() );
+    if (queue->shm_mapping) release_object( queue->shm_mapping );
 }
 
 static void msg_queue_poll_event( struct fd *fd, int event )
@@ -1475,6 +1520,7 @@ static void queue_hardware_message( struct desktop *desktop, struct message *msg
     unsigned int msg_code;
 
     update_input_key_state( desktop, desktop->keystate, msg );
+    update_desktop_shm( desktop );
     last_input_time = get_tick_count();
     if (msg->msg != WM_MOUSEMOVE) always_queue = 1;
 
@@ -1495,6 +1541,7 @@ static void queue_hardware_message( struct desktop *desktop, struct message *msg
             desktop->cursor.x = x;
             desktop->cursor.y = y;
             desktop->cursor.last_change = get_tick_count();
+            update_desktop_shm( desktop );
         }
         if (desktop->keystate[VK_LBUTTON] & 0x80)  msg->wparam |= MK_LBUTTON;
         if (desktop->keystate[VK_MBUTTON] & 0x80)  msg->wparam |= MK_MBUTTON;
@@ -1611,6 +1658,7 @@ static int queue_mouse_message( struct desktop *desktop, user_handle_t win, cons
     };
 
     desktop->cursor.last_change = get_tick_count();
+    update_desktop_shm( desktop );
     flags = input->mouse.flags;
     time  = input->mouse.time;
     if (!time) time = desktop->cursor.last_change;
@@ -2216,9 +2264,25 @@ DECL_HANDLER(is_window_hung)
 DECL_HANDLER(get_msg_queue)
 {
     struct msg_queue *queue = get_current_queue();
+    void *ptr;
 
     reply->handle = 0;
-    if (queue) reply->handle = alloc_handle( current->process, queue, SYNCHRONIZE, 0 );
+    reply->shm_mapping = 0;
+    if (!queue) return;
+    reply->handle = alloc_handle( current->process, queue, SYNCHRONIZE, 0 );
+
+    /* the shared state is optional, the client falls back to server calls without it */
+    if (!queue->shm_mapping)
+    {
+        if (!(queue->shm_mapping = create_shared_mapping( sizeof(queue_shm_t), &ptr )))
+        {
+            clear_error();
+            return;
+        }
+        queue->shm = ptr;
+        update_queue_shm( queue );
+    }
+    reply->shm_mapping = alloc_handle( current->process, queue->shm_mapping, SECTION_MAP_READ, 0 );
 }
 
 
@@ -2277,6 +2341,7 @@ DECL_HANDLER(get_queue_status)
         reply->wake_bits    = queue->wake_bits;
         reply->changed_bits = queue->changed_bits;
         queue->changed_bits &= ~req->clear_bits;
+        update_queue_shm( queue );
     }
     else reply->wake_bits = reply->changed_bits = 0;
 }
@@ -2452,6 +2517,7 @@ DECL_HANDLER(get_message)
     }
     if (filter & QS_INPUT) queue->changed_bits &= ~QS_INPUT;
     if (filter & QS_PAINT) queue->changed_bits &= ~QS_PAINT;
+    update_queue_shm( queue );
 
     /* then check for posted messages */
     if ((filter & QS_POSTMESSAGE) &&
@@ -2882,6 +2948,7 @@ DECL_HANDLER(get_key_state)
         {
             reply->state = desktop->keystate[req->key & 0xff];
             desktop->keystate[req->key & 0xff] &= ~0x40;
+            update_desktop_shm( desktop );
         }
         set_reply_data( desktop->keystate, size );
         release_object( desktop );
@@ -2912,6 +2979,25 @@ DECL_HANDLER(get_key_state)
 }
 
 
+/* get the mapping of the desktop input state shared with the clients */
+DECL_HANDLER(get_desktop_shm)
+{
+    struct desktop *desktop;
+    void *ptr;
+
+    if (!(desktop = get_thread_desktop( current, 0 ))) return;
+    if (!desktop->shm_mapping &&
+        (desktop->shm_mapping = create_shared_mapping( sizeof(desktop_shm_t), &ptr )))
+    {
+        desktop->shm = ptr;
+        update_desktop_shm( desktop );
+    }
+    if (desktop->shm_mapping)
+        reply->handle = alloc_handle( current->process, desktop->shm_mapping, SECTION_MAP_READ, 0 );
+    release_object( desktop );
+}
+
+
 /* set queue keyboard state for a given thread */
 DECL_HANDLER(set_key_state)
 {
@@ -2923,6 +3009,7 @@ DECL_HANDLER(set_key_state)
     {
         if (!(desktop = get_thread_desktop( current, 0 ))) return;
         memcpy( desktop->keystate, get_req_data(), size );
+        update_desktop_shm( desktop );
         release_object( desktop );
     }
     else
@@ -2932,6 +3019,7 @@ DECL_HANDLER(set_key_state)
         if (req->async && (desktop = get_thread_desktop( thread, 0 )))
         {
             memcpy( desktop->keystate, get_req_data(), size );
+            update_desktop_shm( desktop );
             release_object( desktop );
         }
         release_object( thread );
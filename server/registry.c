@@ -49,6 +49,7 @@
 
 #include "winternl.h"
 #include "wine/library.h"
+#include "wine/rbtree.h"
 
 struct notify
 {
@@ -69,9 +70,11 @@ struct key
     unsigned short    namelen;     /* length of key name */
     unsigned short    classlen;    /* length of class name */
     struct key       *parent;      /* parent key */
-    int               last_subkey; /* last in use subkey */
-    int               nb_subkeys;  /* count of allocated subkeys */
-    struct key      **subkeys;     /* subkeys array */
+    struct wine_rb_entry entry;    /* entry in parent subkeys tree */
+    struct wine_rb_tree subkeys;   /* subkeys tree, sorted by name */
+    int               nb_subkeys;  /* number of subkeys */
+    int               enum_index;  /* index of the last subkey returned by get_subkey */
+    struct key       *enum_subkey; /* last subkey returned by get_subkey */
     int               last_value;  /* last in use value */
     int               nb_values;   /* count of allocated values in array */
     struct key_value *values;      /* values array */
@@ -98,12 +101,13 @@ struct key_value
     void             *data;    /* pointer to value data */
 };
 
-#define MIN_SUBKEYS  8   /* min. number of allocated subkeys per key */
 #define MIN_VALUES   8   /* min. number of allocated values per key */
 
 #define MAX_NAME_LEN  256    /* max. length of a key name */
 #define MAX_VALUE_LEN 16383  /* max. length of a value name */
 
+#define REGISTRY_IO_BUFFER_SIZE (256 * 1024)  /* stdio buffer size for registry files */
+
 /* the root of the registry tree */
 static struct key *root_key;
 
@@ -204,7 +208,11 @@ static void dump_path( const struct key *key, const struct key *base, FILE *f )
 /* dump a value to a text file */
 static void dump_value( const struct key_value *value, FILE *f )
 {
+    static const char hex[16] = "0123456789abcdef";
+    const unsigned char *data;
     unsigned int i, dw;
+    char buffer[256];
+    char *pos;
     int count;
 
     if (value->namelen)
@@ -239,31 +247,45 @@ static void dump_value( const struct key_value *value, FILE *f )
 
     if (value->type == REG_BINARY) count += fprintf( f, "hex:" );
     else count += fprintf( f, "hex(%x):", value->type );
+
+    /* format the data by hand, binary values can be large and fprintf is slow */
+    data = value->data;
+    pos = buffer;
     for (i = 0; i < value->len; i++)
     {
-        count += fprintf( f, "%02x", *((unsigned char *)value->data + i) );
+        if (pos > buffer + sizeof(buffer) - 8)
+        {
+            fwrite( buffer, pos - buffer, 1, f );
+            pos = buffer;
+        }
+        *pos++ = hex[data[i] >> 4];
+        *pos++ = hex[data[i] & 0x0f];
+        count += 2;
         if (i < value->len-1)
         {
-            fputc( ',', f );
+            *pos++ = ',';
             if (++count > 76)
             {
-                fprintf( f, "\\\n  " );
+                memcpy( pos, "\\\n  ", 4 );
+                pos += 4;
                 count = 2;
             }
         }
     }
-    fputc( '\n', f );
+    *pos++ = '\n';
+    fwrite( buffer, pos - buffer, 1, f );
 }
 
 /* save a registry and all its subkeys to a text file */
 static void save_subkeys( const struct key *key, const struct key *base, FILE *f )
 {
+    struct key *subkey;
     int i;
 
     if (key->flags & KEY_VOLATILE) return;
     /* save key if it has either some values or no subkeys, or needs special options */
     /* keys with no values but subkeys are saved implicitly by saving the subkeys */
-    if ((key->last_value >= 0) || (key->last_subkey == -1) || key->class || (key->flags & KEY_SYMLINK))
+    if ((key->last_value >= 0) || !key->nb_subkeys || key->class || (key->flags & KEY_SYMLINK))
     {
         fprintf( f, "\n[" );
         if (key != base) dump_path( key, base, f );
@@ -278,7 +300,8 @@ static void save_subkeys( const struct key *key, const struct key *base, FILE *f
         if (key->flags & KEY_SYMLINK) fputs( "#link\n", f );
         for (i = 0; i <= key->last_value; i++) dump_value( &key->values[i], f );
     }
-    for (i = 0; i <= key->last_subkey; i++) save_subkeys( key->subkeys[i], base, f );
+    WINE_RB_FOR_EACH_ENTRY( subkey, &key->subkeys, struct key, entry )
+        save_subkeys( subkey, base, f );
 }
 
 static void dump_operation( const struct key *key, const struct key_value *value, const char *op )
@@ -403,6 +426,14 @@ static int key_close_handle( struct object *obj, struct process *process, obj_ha
     return 1;  /* ok to close */
 }
 
+static void release_subkey( struct wine_rb_entry *entry, void *context )
+{
+    struct key *subkey = WINE_RB_ENTRY_VALUE( entry, struct key, entry );
+
+    subkey->parent = NULL;
+    release_object( subkey );
+}
+
 static void key_destroy( struct object *obj )
 {
     int i;
@@ -418,12 +449,7 @@ static void key_destroy( struct object *obj )
         free( key->values[i].data );
     }
     free( key->values );
-    for (i = 0; i <= key->last_subkey; i++)
-    {
-        key->subkeys[i]->parent = NULL;
-        release_object( key->subkeys[i] );
-    }
-    free( key->subkeys );
+    wine_rb_destroy( &key->subkeys, release_subkey, NULL );
     /* unconditionally notify everything waiting on this key */
     while ((ptr = list_head( &key->notify_list )))
     {
@@ -473,6 +499,18 @@ static struct unicode_str *get_path_token( const struct unicode_str *path, struc
     return token;
 }
 
+/* compare a name with the name of a subkey, for the subkeys tree */
+static int compare_subkey( const void *key, const struct wine_rb_entry *entry )
+{
+    const struct unicode_str *name = key;
+    const struct key *subkey = WINE_RB_ENTRY_VALUE( entry, const struct key, entry );
+    data_size_t len = min( subkey->namelen, name->len );
+    int res;
+
+    if ((res = memicmpW( name->str, subkey->name, len / sizeof(WCHAR) ))) return res;
+    return name->len - subkey->namelen;
+}
+
 /* allocate a key object */
 static struct key *alloc_key( const struct unicode_str *name, timeout_t modif )
 {
@@ -484,14 +522,15 @@ static struct key *alloc_key( const struct unicode_str *name, timeout_t modif )
         key->namelen     = name->len;
         key->classlen    = 0;
         key->flags       = 0;
-        key->last_subkey = -1;
         key->nb_subkeys  = 0;
-        key->subkeys     = NULL;
+        key->enum_index  = -1;
+        key->enum_subkey = NULL;
         key->nb_values   = 0;
         key->last_value  = -1;
         key->values      = NULL;
         key->modif       = modif;
         key->parent      = NULL;
+        wine_rb_init( &key->subkeys, compare_subkey );
         list_init( &key->notify_list );
         if (name->len && !(key->name = memdup( name->str, name->len )))
         {
@@ -516,12 +555,12 @@ static void make_dirty( struct key *key )
 /* mark a key and all its subkeys as clean (not modified) */
 static void make_clean( struct key *key )
 {
-    int i;
+    struct key *subkey;
 
     if (key->flags & KEY_VOLATILE) return;
     if (!(key->flags & KEY_DIRTY)) return;
     key->flags &= ~KEY_DIRTY;
-    for (i = 0; i <= key->last_subkey; i++) make_clean( key->subkeys[i] );
+    WINE_RB_FOR_EACH_ENTRY( subkey, &key->subkeys, struct key, entry ) make_clean( subkey );
 }
 
 /* go through all the notifications and send them if necessary */
@@ -551,54 +590,22 @@ static void touch_key( struct key *key, unsigned int change )
         check_notify( k, change & ~REG_NOTIFY_CHANGE_LAST_SET, 0 );
 }
 
-/* try to grow the array of subkeys; return 1 if OK, 0 on error */
-static int grow_subkeys( struct key *key )
-{
-    struct key **new_subkeys;
-    int nb_subkeys;
-
-    if (key->nb_subkeys)
-    {
-        nb_subkeys = key->nb_subkeys + (key->nb_subkeys / 2);  /* grow by 50% */
-        if (!(new_subkeys = realloc( key->subkeys, nb_subkeys * sizeof(*new_subkeys) )))
-        {
-            set_error( STATUS_NO_MEMORY );
-            return 0;
-        }
-    }
-    else
-    {
-        nb_subkeys = MIN_VALUES;
-        if (!(new_subkeys = mem_alloc( nb_subkeys * sizeof(*new_subkeys) ))) return 0;
-    }
-    key->subkeys    = new_subkeys;
-    key->nb_subkeys = nb_subkeys;
-    return 1;
-}
-
-/* allocate a subkey for a given key, and return its index */
-static struct key *alloc_subkey( struct key *parent, const struct unicode_str *name,
-                                 int index, timeout_t modif )
+/* allocate a subkey for a given key */
+static struct key *alloc_subkey( struct key *parent, const struct unicode_str *name, timeout_t modif )
 {
     struct key *key;
-    int i;
 
     if (name->len > MAX_NAME_LEN * sizeof(WCHAR))
     {
         set_error( STATUS_INVALID_PARAMETER );
         return NULL;
     }
-    if (parent->last_subkey + 1 == parent->nb_subkeys)
-    {
-        /* need to grow the array */
-        if (!grow_subkeys( parent )) return NULL;
-    }
     if ((key = alloc_key( name, modif )) != NULL)
     {
         key->parent = parent;
-        for (i = ++parent->last_subkey; i > index; i--)
-            parent->subkeys[i] = parent->subkeys[i-1];
-        parent->subkeys[index] = key;
+        wine_rb_put( &parent->subkeys, name, &key->entry );
+        parent->nb_subkeys++;
+        parent->enum_subkey = NULL;
         if (is_wow6432node( key->name, key->namelen ) && !is_wow6432node( parent->name, parent->namelen ))
             parent->flags |= KEY_WOW64;
     }
@@ -606,71 +613,69 @@ static struct key *alloc_subkey( struct key *parent, const struct unicode_str *n
 }
 
 /* free a subkey of a given key */
-static void free_subkey( struct key *parent, int index )
+static void free_subkey( struct key *parent, struct key *key )
 {
-    struct key *key;
-    int i, nb_subkeys;
+    assert( key->parent == parent );
 
-    assert( index >= 0 );
-    assert( index <= parent->last_subkey );
-
-    key = parent->subkeys[index];
-    for (i = index; i < parent->last_subkey; i++) parent->subkeys[i] = parent->subkeys[i + 1];
-    parent->last_subkey--;
+    wine_rb_remove( &parent->subkeys, &key->entry );
+    parent->nb_subkeys--;
+    parent->enum_subkey = NULL;
     key->flags |= KEY_DELETED;
     key->parent = NULL;
     if (is_wow6432node( key->name, key->namelen )) parent->flags &= ~KEY_WOW64;
     release_object( key );
+}
 
-    /* try to shrink the array */
-    nb_subkeys = parent->nb_subkeys;
-    if (nb_subkeys > MIN_SUBKEYS && parent->last_subkey < nb_subkeys / 2)
-    {
-        struct key **new_subkeys;
-        nb_subkeys -= nb_subkeys / 3;  /* shrink by 33% */
-        if (nb_subkeys < MIN_SUBKEYS) nb_subkeys = MIN_SUBKEYS;
-        if (!(new_subkeys = realloc( parent->subkeys, nb_subkeys * sizeof(*new_subkeys) ))) return;
-        parent->subkeys = new_subkeys;
-        parent->nb_subkeys = nb_subkeys;
-    }
+/* find the named child of a given key */
+static struct key *find_subkey( const struct key *key, const struct unicode_str *name )
+{
+    struct wine_rb_entry *entry;
+
+    if (!(entry = wine_rb_get( &key->subkeys, name ))) return NULL;
+    return WINE_RB_ENTRY_VALUE( entry, struct key, entry );
 }
 
-/* find the named child of a given key and return its index */
-static struct key *find_subkey( const struct key *key, const struct unicode_str *name, int *index )
+/* return the subkey at a given index in the sorted subkeys list */
+/* sequential enumeration is optimized by remembering the last position */
+static struct key *get_subkey( struct key *key, int index )
 {
-    int i, min, max, res;
-    data_size_t len;
+    struct wine_rb_entry *entry;
+    int pos;
 
-    min = 0;
-    max = key->last_subkey;
-    while (min <= max)
+    if (index < 0 || index >= key->nb_subkeys) return NULL;
+
+    if (key->enum_subkey && abs( index - key->enum_index ) <= min( index, key->nb_subkeys - 1 - index ))
     {
-        i = (min + max) / 2;
-        len = min( key->subkeys[i]->namelen, name->len );
-        res = memicmpW( key->subkeys[i]->name, name->str, len / sizeof(WCHAR) );
-        if (!res) res = key->subkeys[i]->namelen - name->len;
-        if (!res)
-        {
-            *index = i;
-            return key->subkeys[i];
-        }
-        if (res > 0) max = i - 1;
-        else min = i + 1;
+        entry = &key->enum_subkey->entry;
+        pos = key->enum_index;
     }
-    *index = min;  /* this is where we should insert it */
-    return NULL;
+    else if (index < key->nb_subkeys - 1 - index)
+    {
+        entry = wine_rb_head( key->subkeys.root );
+        pos = 0;
+    }
+    else
+    {
+        entry = wine_rb_tail( key->subkeys.root );
+        pos = key->nb_subkeys - 1;
+    }
+    for ( ; pos < index; pos++) entry = wine_rb_next( entry );
+    for ( ; pos > index; pos--) entry = wine_rb_prev( entry );
+
+    key->enum_index = index;
+    key->enum_subkey = WINE_RB_ENTRY_VALUE( entry, struct key, entry );
+    return key->enum_subkey;
 }
 
 /* return the wow64 variant of the key, or the key itself if none */
 static struct key *find_wow64_subkey( struct key *key, const struct unicode_str *name )
 {
     static const struct unicode_str wow6432node_str = { wow6432node, sizeof(wow6432node) };
-    int index;
 
     if (!(key->flags & KEY_WOW64)) return key;
     if (!is_wow6432node( name->str, name->len ))
     {
-        key = find_subkey( key, &wow6432node_str, &index );
+        key = find_subkey( key, &wow6432node_str );
         assert( key );  /* if KEY_WOW64 is set we must find it */
     }
     return key;
@@ -700,7 +705,7 @@ static struct key *follow_symlink( struct key *key, int iteration )
     if (!get_path_token( &path, &token )) return NULL;
     while (token.len)
     {
-        if (!(key = find_subkey( key, &token, &index ))) break;
+        if (!(key = find_subkey( key, &token ))) break;
         if (!(key = follow_symlink( key, iteration + 1 ))) break;
         get_path_token( &path, &token );
     }
@@ -710,7 +715,7 @@ static struct key *follow_symlink( struct key *key, int iteration )
 /* open a key until we find an element that doesn't exist */
 /* helper for open_key and create_key */
 static struct key *open_key_prefix( struct key *key, const struct unicode_str *name,
-                                    unsigned int access, struct unicode_str *token, int *index )
+                                    unsigned int access, struct unicode_str *token )
 {
     token->str = NULL;
     if (!get_path_token( name, token )) return NULL;
@@ -718,13 +723,13 @@ static struct key *open_key_prefix( struct key *key, const struct unicode_str *n
     while (token->len)
     {
         struct key *subkey;
-        if (!(subkey = find_subkey( key, token, index )))
+        if (!(subkey = find_subkey( key, token )))
         {
             if ((key->flags & KEY_WOWSHARE) && !(access & KEY_WOW64_64KEY))
             {
                 /* try in the 64-bit parent */
                 key = key->parent;
-                subkey = find_subkey( key, token, index );
+                subkey = find_subkey( key, token );
             }
         }
         if (!subkey) break;
@@ -745,10 +750,9 @@ static struct key *open_key_prefix( struct key *key, const struct unicode_str *n
 static struct key *open_key( struct key *key, const struct unicode_str *name, unsigned int access,
                              unsigned int attributes )
 {
-    int index;
     struct unicode_str token;
 
-    if (!(key = open_key_prefix( key, name, access, &token, &index ))) return NULL;
+    if (!(key = open_key_prefix( key, name, access, &token ))) return NULL;
 
     if (token.len)
     {
@@ -772,11 +776,10 @@ static struct key *create_key( struct key *key, const struct unicode_str *name,
                                unsigned int access, unsigned int attributes,
                                const struct security_descriptor *sd, int *created )
 {
-    int index;
     struct unicode_str token, next;
 
     *created = 0;
-    if (!(key = open_key_prefix( key, name, access, &token, &index ))) return NULL;
+    if (!(key = open_key_prefix( key, name, access, &token ))) return NULL;
 
     if (!token.len)  /* the key already exists */
     {
@@ -812,7 +815,7 @@ static struct key *create_key( struct key *key, const struct unicode_str *name,
     }
     *created = 1;
     make_dirty( key );
-    if (!(key = alloc_subkey( key, &token, index, current_time ))) return NULL;
+    if (!(key = alloc_subkey( key, &token, current_time ))) return NULL;
 
     if (options & REG_OPTION_CREATE_LINK) key->flags |= KEY_SYMLINK;
     if (options & REG_OPTION_VOLATILE) key->flags |= KEY_VOLATILE;
@@ -837,7 +840,6 @@ static struct key *create_key( struct key *key, const struct unicode_str *name,
 static struct key *create_key_recursive( struct key *key, const struct unicode_str *name, timeout_t modif )
 {
     struct key *base;
-    int index;
     struct unicode_str token;
 
     token.str = NULL;
@@ -845,7 +847,7 @@ static struct key *create_key_recursive( struct key *key, const struct unicode_s
     while (token.len)
     {
         struct key *subkey;
-        if (!(subkey = find_subkey( key, &token, &index ))) break;
+        if (!(subkey = find_subkey( key, &token ))) break;
         key = subkey;
         if (!(key = follow_symlink( key, 0 )))
         {
@@ -857,16 +859,15 @@ static struct key *create_key_recursive( struct key *key, const struct unicode_s
 
     if (token.len)
     {
-        if (!(key = alloc_subkey( key, &token, index, modif ))) return NULL;
+        if (!(key = alloc_subkey( key, &token, modif ))) return NULL;
         base = key;
         for (;;)
         {
             get_path_token( name, &token );
             if (!token.len) break;
-            /* we know the index is always 0 in a new key */
-            if (!(key = alloc_subkey( key, &token, 0, modif )))
+            if (!(key = alloc_subkey( key, &token, modif )))
             {
-                free_subkey( base, index );
+                free_subkey( base->parent, base );
                 return NULL;
             }
         }
@@ -877,7 +878,7 @@ static struct key *create_key_recursive( struct key *key, const struct unicode_s
 }
 
 /* query information about a key or a subkey */
-static void enum_key( const struct key *key, int index, int info_class,
+static void enum_key( struct key *key, int index, int info_class,
                       struct enum_key_reply *reply )
 {
     static const WCHAR backslash[] = { '\\' };
@@ -886,16 +887,16 @@ static void enum_key( const struct key *key, int index, int info_class,
     data_size_t max_subkey = 0, max_class = 0;
     data_size_t max_value = 0, max_data = 0;
     const struct key *k;
+    struct key *subkey;
     char *data;
 
     if (index != -1)  /* -1 means use the specified key directly */
     {
-        if ((index < 0) || (index > key->last_subkey))
+        if (!(key = get_subkey( key, index )))
         {
             set_error( STATUS_NO_MORE_ENTRIES );
             return;
         }
-        key = key->subkeys[index];
     }
 
     namelen = key->namelen;
@@ -921,10 +922,10 @@ static void enum_key( const struct key *key, int index, int info_class,
         break;
     case KeyFullInformation:
     case KeyCachedInformation:
-        for (i = 0; i <= key->last_subkey; i++)
+        WINE_RB_FOR_EACH_ENTRY( subkey, &key->subkeys, struct key, entry )
         {
-            if (key->subkeys[i]->namelen > max_subkey) max_subkey = key->subkeys[i]->namelen;
-            if (key->subkeys[i]->classlen > max_class) max_class = key->subkeys[i]->classlen;
+            if (subkey->namelen > max_subkey) max_subkey = subkey->namelen;
+            if (subkey->classlen > max_class) max_class = subkey->classlen;
         }
         for (i = 0; i <= key->last_value; i++)
         {
@@ -944,7 +945,7 @@ static void enum_key( const struct key *key, int index, int info_class,
         set_error( STATUS_INVALID_PARAMETER );
         return;
     }
-    reply->subkeys = key->last_subkey + 1;
+    reply->subkeys = key->nb_subkeys;
     reply->values  = key->last_value + 1;
     reply->modif   = key->modif;
     reply->total   = namelen + classlen;
@@ -985,10 +986,9 @@ static void enum_key( const struct key *key, int index, int info_class,
 /* delete a key and its values */
 static int delete_key( struct key *key, int recurse )
 {
-    int index;
     struct key *parent = key->parent;
 
-    /* must find parent and index */
+    /* must find parent */
     if (key == root_key)
     {
         set_error( STATUS_ACCESS_DENIED );
@@ -996,23 +996,19 @@ static int delete_key( struct key *key, int recurse )
     }
     assert( parent );
 
-    while (recurse && (key->last_subkey>=0))
-        if (0 > delete_key(key->subkeys[key->last_subkey], 1))
+    while (recurse && key->nb_subkeys)
+        if (0 > delete_key( WINE_RB_ENTRY_VALUE( wine_rb_tail( key->subkeys.root ), struct key, entry ), 1 ))
             return -1;
 
-    for (index = 0; index <= parent->last_subkey; index++)
-        if (parent->subkeys[index] == key) break;
-    assert( index <= parent->last_subkey );
-
     /* we can only delete a key that has no subkeys */
-    if (key->last_subkey >= 0)
+    if (key->nb_subkeys)
     {
         set_error( STATUS_ACCESS_DENIED );
         return -1;
     }
 
     if (debug_level > 1) dump_operation( key, NULL, "Delete" );
-    free_subkey( parent, index );
+    free_subkey( parent, key );
     touch_key( parent, REG_NOTIFY_CHANGE_NAME );
     return 0;
 }
@@ -1073,7 +1069,6 @@ static struct key_value *insert_value( struct key *key, const struct unicode_str
 {
     struct key_value *value;
     WCHAR *new_name = NULL;
-    int i;
 
     if (name->len > MAX_VALUE_LEN * sizeof(WCHAR))
     {
@@ -1085,7 +1080,9 @@ static struct key_value *insert_value( struct key *key, const struct unicode_str
         if (!grow_values( key )) return NULL;
     }
     if (name->len && !(new_name = memdup( name->str, name->len ))) return NULL;
-    for (i = ++key->last_value; i > index; i--) key->values[i] = key->values[i - 1];
+    key->last_value++;
+    memmove( &key->values[index + 1], &key->values[index],
+             (key->last_value - index) * sizeof(*key->values) );
     value = &key->values[index];
     value->name    = new_name;
     value->namelen = name->len;
@@ -1217,7 +1214,7 @@ static void enum_value( struct key *key, int i, int info_class, struct enum_key_
 static void delete_value( struct key *key, const struct unicode_str *name )
 {
     struct key_value *value;
-    int i, index, nb_values;
+    int index, nb_values;
 
     if (!(value = find_value( key, name, &index )))
     {
@@ -1227,7 +1224,8 @@ static void delete_value( struct key *key, const struct unicode_str *name )
     if (debug_level > 1) dump_operation( key, value, "Delete" );
     free( value->name );
     free( value->data );
-    for (i = index; i < key->last_value; i++) key->values[i] = key->values[i + 1];
+    memmove( &key->values[index], &key->values[index + 1],
+             (key->last_value - index) * sizeof(*key->values) );
     key->last_value--;
     touch_key( key, REG_NOTIFY_CHANGE_LAST_SET );
 
@@ -1632,8 +1630,8 @@ static void load_keys( struct key *key, const char *filename, FILE *f, int prefi
 
     info.filename = filename;
     info.file   = f;
-    info.len    = 4;
-    info.tmplen = 4;
+    info.len    = 256;
+    info.tmplen = 256;
     info.line   = 0;
     if (!(info.buffer = mem_alloc( info.len ))) return;
     if (!(info.tmp = mem_alloc( info.tmplen )))
@@ -1707,6 +1705,7 @@ static void load_registry( struct key *key, obj_handle_t handle )
         FILE *f = fdopen( fd, "r" );
         if (f)
         {
+            setvbuf( f, NULL, _IOFBF, REGISTRY_IO_BUFFER_SIZE );
             load_keys( key, NULL, f, -1 );
             fclose( f );
         }
@@ -1721,6 +1720,7 @@ static int load_init_registry_from_file( const char *filename, struct key *key )
 
     if ((f = fopen( filename, "r" )))
     {
+        setvbuf( f, NULL, _IOFBF, REGISTRY_IO_BUFFER_SIZE );
         load_keys( key, filename, f, 0 );
         fclose( f );
         if (get_error() == STATUS_NOT_REGISTRY_FILE)
@@ -1905,6 +1905,7 @@ static void save_registry( struct key *key, obj_handle_t handle )
         FILE *f = fdopen( fd, "w" );
         if (f)
         {
+            setvbuf( f, NULL, _IOFBF, REGISTRY_IO_BUFFER_SIZE );
             save_all_subkeys( key, f );
             if (fclose( f )) file_set_error();
         }
@@ -1974,6 +1975,7 @@ static int save_branch( struct key *key, const char *path )
         dump_operation( key, NULL, "saving" );
     }
 
+    setvbuf( f, NULL, _IOFBF, REGISTRY_IO_BUFFER_SIZE );
     save_all_subkeys( key, f );
     ret = !fclose(f);
 
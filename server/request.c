@@ -75,6 +75,9 @@
 #define SCM_RIGHTS 1
 #endif
 
+/* size of the per-thread buffer used to read request data along with the request header */
+#define REQUEST_PREREAD_SIZE 1024
+
 /* path names for server master Unix socket */
 static const char * const server_socket_name = "socket";   /* name of the socket file */
 static const char * const server_lock_name = "lock";       /* name of the server lock file */
@@ -329,23 +332,50 @@ void read_request( struct thread *thread )
 
     if (!thread->req_toread)  /* no pending request */
     {
-        if ((ret = read( get_unix_fd( thread->request_fd ), &thread->req,
-                         sizeof(thread->req) )) != sizeof(thread->req)) goto error;
-        if (!(thread->req_toread = thread->req.request_header.request_size))
+        struct iovec vec[2];
+
+        /* read the header and the start of the variable sized data in a single call */
+        if (!thread->req_data && !(thread->req_data = malloc( REQUEST_PREREAD_SIZE )))
         {
-            /* no data, handle request at once */
-            call_req_handler( thread );
+            fatal_protocol_error( thread, "no memory for request data\n" );
             return;
         }
-        if (!(thread->req_data = malloc( thread->req_toread )))
+        vec[0].iov_base = &thread->req;
+        vec[0].iov_len  = sizeof(thread->req);
+        vec[1].iov_base = thread->req_data;
+        vec[1].iov_len  = REQUEST_PREREAD_SIZE;
+
+        if ((ret = readv( get_unix_fd( thread->request_fd ), vec, 2 )) < (int)sizeof(thread->req))
+            goto error;
+        ret -= sizeof(thread->req);
+        if (ret > thread->req.request_header.request_size)
         {
-            fatal_protocol_error( thread, "no memory for %u bytes request %d\n",
-                                  thread->req_toread, thread->req.request_header.req );
+            fatal_protocol_error( thread, "extra data after request %d\n",
+                                  thread->req.request_header.req );
+            return;
+        }
+        if (!(thread->req_toread = thread->req.request_header.request_size - ret))
+        {
+            /* all the data is there, handle request at once */
+            call_req_handler( thread );
             return;
         }
+        if (thread->req.request_header.request_size > REQUEST_PREREAD_SIZE)
+        {
+            void *data = realloc( thread->req_data, thread->req.request_header.request_size );
+
+            if (!data)
+            {
+                fatal_protocol_error( thread, "no memory for %u bytes request %d\n",
+                                      thread->req.request_header.request_size,
+                                      thread->req.request_header.req );
+                return;
+            }
+            thread->req_data = data;
+        }
     }
 
-    /* read the variable sized data */
+    /* read the rest of the variable sized data */
     for (;;)
     {
         ret = read( get_unix_fd( thread->request_fd ),
@@ -356,8 +386,12 @@ void read_request( struct thread *thread )
         if (!(thread->req_toread -= ret))
         {
             call_req_handler( thread );
-            free( thread->req_data );
-            thread->req_data = NULL;
+            /* don't keep large buffers around, the next request will allocate a new one */
+            if (thread->req.request_header.request_size > REQUEST_PREREAD_SIZE)
+            {
+                free( thread->req_data );
+                thread->req_data = NULL;
+            }
             return;
         }
     }
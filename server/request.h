@@ -152,6 +152,8 @@ DECL_HANDLER(create_semaphore);
 DECL_HANDLER(release_semaphore);
 DECL_HANDLER(query_semaphore);
 DECL_HANDLER(open_semaphore);
+DECL_HANDLER(get_fast_sync_shm);
+DECL_HANDLER(fast_sync_wake);
 DECL_HANDLER(create_file);
 DECL_HANDLER(open_file_object);
 DECL_HANDLER(alloc_file_handle);
@@ -277,6 +279,7 @@ DECL_HANDLER(get_window_children_from_point);
 DECL_HANDLER(get_window_tree);
 DECL_HANDLER(set_window_pos);
 DECL_HANDLER(get_window_rectangles);
+DECL_HANDLER(get_window_shm);
 DECL_HANDLER(get_window_text);
 DECL_HANDLER(set_window_text);
 DECL_HANDLER(get_windows_offset);
@@ -311,6 +314,7 @@ DECL_HANDLER(attach_thread_input);
 DECL_HANDLER(get_thread_input);
 DECL_HANDLER(get_last_input_time);
 DECL_HANDLER(get_key_state);
+DECL_HANDLER(get_desktop_shm);
 DECL_HANDLER(set_key_state);
 DECL_HANDLER(set_foreground_window);
 DECL_HANDLER(set_focus_window);
@@ -375,6 +379,7 @@ DECL_HANDLER(create_completion);
 DECL_HANDLER(open_completion);
 DECL_HANDLER(add_completion);
 DECL_HANDLER(remove_completion);
+DECL_HANDLER(remove_completions);
 DECL_HANDLER(query_completion);
 DECL_HANDLER(set_completion_info);
 DECL_HANDLER(add_fd_completion);
@@ -441,6 +446,8 @@ static const req_handler req_handlers[REQ_NB_REQUESTS] =
     (req_handler)req_release_semaphore,
     (req_handler)req_query_semaphore,
     (req_handler)req_open_semaphore,
+    (req_handler)req_get_fast_sync_shm,
+    (req_handler)req_fast_sync_wake,
     (req_handler)req_create_file,
     (req_handler)req_open_file_object,
     (req_handler)req_alloc_file_handle,
@@ -566,6 +573,7 @@ static const req_handler req_handlers[REQ_NB_REQUESTS] =
     (req_handler)req_get_window_tree,
     (req_handler)req_set_window_pos,
     (req_handler)req_get_window_rectangles,
+    (req_handler)req_get_window_shm,
     (req_handler)req_get_window_text,
     (req_handler)req_set_window_text,
     (req_handler)req_get_windows_offset,
@@ -600,6 +608,7 @@ static const req_handler req_handlers[REQ_NB_REQUESTS] =
     (req_handler)req_get_thread_input,
     (req_handler)req_get_last_input_time,
     (req_handler)req_get_key_state,
+    (req_handler)req_get_desktop_shm,
     (req_handler)req_set_key_state,
     (req_handler)req_set_foreground_window,
     (req_handler)req_set_focus_window,
@@ -664,6 +673,7 @@ static const req_handler req_handlers[REQ_NB_REQUESTS] =
     (req_handler)req_open_completion,
     (req_handler)req_add_completion,
     (req_handler)req_remove_completion,
+    (req_handler)req_remove_completions,
     (req_handler)req_query_completion,
     (req_handler)req_set_completion_info,
     (req_handler)req_add_fd_completion,
@@ -902,8 +912,10 @@ C_ASSERT( sizeof(struct select_reply) == 64 );
 C_ASSERT( FIELD_OFFSET(struct create_event_request, access) == 12 );
 C_ASSERT( FIELD_OFFSET(struct create_event_request, manual_reset) == 16 );
 C_ASSERT( FIELD_OFFSET(struct create_event_request, initial_state) == 20 );
-C_ASSERT( sizeof(struct create_event_request) == 24 );
+C_ASSERT( FIELD_OFFSET(struct create_event_request, fast_sync) == 24 );
+C_ASSERT( sizeof(struct create_event_request) == 32 );
 C_ASSERT( FIELD_OFFSET(struct create_event_reply, handle) == 8 );
+C_ASSERT( FIELD_OFFSET(struct create_event_reply, fast_sync) == 12 );
 C_ASSERT( sizeof(struct create_event_reply) == 16 );
 C_ASSERT( FIELD_OFFSET(struct event_op_request, handle) == 12 );
 C_ASSERT( FIELD_OFFSET(struct event_op_request, op) == 16 );
@@ -953,8 +965,10 @@ C_ASSERT( sizeof(struct query_mutex_reply) == 24 );
 C_ASSERT( FIELD_OFFSET(struct create_semaphore_request, access) == 12 );
 C_ASSERT( FIELD_OFFSET(struct create_semaphore_request, initial) == 16 );
 C_ASSERT( FIELD_OFFSET(struct create_semaphore_request, max) == 20 );
-C_ASSERT( sizeof(struct create_semaphore_request) == 24 );
+C_ASSERT( FIELD_OFFSET(struct create_semaphore_request, fast_sync) == 24 );
+C_ASSERT( sizeof(struct create_semaphore_request) == 32 );
 C_ASSERT( FIELD_OFFSET(struct create_semaphore_reply, handle) == 8 );
+C_ASSERT( FIELD_OFFSET(struct create_semaphore_reply, fast_sync) == 12 );
 C_ASSERT( sizeof(struct create_semaphore_reply) == 16 );
 C_ASSERT( FIELD_OFFSET(struct release_semaphore_request, handle) == 12 );
 C_ASSERT( FIELD_OFFSET(struct release_semaphore_request, count) == 16 );
@@ -972,6 +986,11 @@ C_ASSERT( FIELD_OFFSET(struct open_semaphore_request, rootdir) == 20 );
 C_ASSERT( sizeof(struct open_semaphore_request) == 24 );
 C_ASSERT( FIELD_OFFSET(struct open_semaphore_reply, handle) == 8 );
 C_ASSERT( sizeof(struct open_semaphore_reply) == 16 );
+C_ASSERT( sizeof(struct get_fast_sync_shm_request) == 16 );
+C_ASSERT( FIELD_OFFSET(struct get_fast_sync_shm_reply, handle) == 8 );
+C_ASSERT( sizeof(struct get_fast_sync_shm_reply) == 16 );
+C_ASSERT( FIELD_OFFSET(struct fast_sync_wake_request, handle) == 12 );
+C_ASSERT( sizeof(struct fast_sync_wake_request) == 16 );
 C_ASSERT( FIELD_OFFSET(struct create_file_request, access) == 12 );
 C_ASSERT( FIELD_OFFSET(struct create_file_request, sharing) == 16 );
 C_ASSERT( FIELD_OFFSET(struct create_file_request, create) == 20 );
@@ -1466,6 +1485,7 @@ C_ASSERT( FIELD_OFFSET(struct init_atom_table_reply, table) == 8 );
 C_ASSERT( sizeof(struct init_atom_table_reply) == 16 );
 C_ASSERT( sizeof(struct get_msg_queue_request) == 16 );
 C_ASSERT( FIELD_OFFSET(struct get_msg_queue_reply, handle) == 8 );
+C_ASSERT( FIELD_OFFSET(struct get_msg_queue_reply, shm_mapping) == 12 );
 C_ASSERT( sizeof(struct get_msg_queue_reply) == 16 );
 C_ASSERT( FIELD_OFFSET(struct set_queue_fd_request, handle) == 12 );
 C_ASSERT( sizeof(struct set_queue_fd_request) == 16 );
@@ -1738,6 +1758,9 @@ C_ASSERT( FIELD_OFFSET(struct get_window_rectangles_reply, window) == 8 );
 C_ASSERT( FIELD_OFFSET(struct get_window_rectangles_reply, visible) == 24 );
 C_ASSERT( FIELD_OFFSET(struct get_window_rectangles_reply, client) == 40 );
 C_ASSERT( sizeof(struct get_window_rectangles_reply) == 56 );
+C_ASSERT( sizeof(struct get_window_shm_request) == 16 );
+C_ASSERT( FIELD_OFFSET(struct get_window_shm_reply, handle) == 8 );
+C_ASSERT( sizeof(struct get_window_shm_reply) == 16 );
 C_ASSERT( FIELD_OFFSET(struct get_window_text_request, handle) == 12 );
 C_ASSERT( sizeof(struct get_window_text_request) == 16 );
 C_ASSERT( sizeof(struct get_window_text_reply) == 8 );
@@ -1906,6 +1929,9 @@ C_ASSERT( FIELD_OFFSET(struct get_key_state_request, key) == 16 );
 C_ASSERT( sizeof(struct get_key_state_request) == 24 );
 C_ASSERT( FIELD_OFFSET(struct get_key_state_reply, state) == 8 );
 C_ASSERT( sizeof(struct get_key_state_reply) == 16 );
+C_ASSERT( sizeof(struct get_desktop_shm_request) == 16 );
+C_ASSERT( FIELD_OFFSET(struct get_desktop_shm_reply, handle) == 8 );
+C_ASSERT( sizeof(struct get_desktop_shm_reply) == 16 );
 C_ASSERT( FIELD_OFFSET(struct set_key_state_request, tid) == 12 );
 C_ASSERT( FIELD_OFFSET(struct set_key_state_request, async) == 16 );
 C_ASSERT( sizeof(struct set_key_state_request) == 24 );
@@ -2283,6 +2309,9 @@ C_ASSERT( FIELD_OFFSET(struct remove_completion_reply, cvalue) == 16 );
 C_ASSERT( FIELD_OFFSET(struct remove_completion_reply, information) == 24 );
 C_ASSERT( FIELD_OFFSET(struct remove_completion_reply, status) == 32 );
 C_ASSERT( sizeof(struct remove_completion_reply) == 40 );
+C_ASSERT( FIELD_OFFSET(struct remove_completions_request, handle) == 12 );
+C_ASSERT( sizeof(struct remove_completions_request) == 16 );
+C_ASSERT( sizeof(struct remove_completions_reply) == 8 );
 C_ASSERT( FIELD_OFFSET(struct query_completion_request, handle) == 12 );
 C_ASSERT( sizeof(struct query_completion_request) == 16 );
 C_ASSERT( FIELD_OFFSET(struct query_completion_reply, depth) == 8 );
@@ -2295,6 +2324,7 @@ C_ASSERT( FIELD_OFFSET(struct add_fd_completion_request, handle) == 12 );
 C_ASSERT( FIELD_OFFSET(struct add_fd_completion_request, cvalue) == 16 );
 C_ASSERT( FIELD_OFFSET(struct add_fd_completion_request, information) == 24 );
 C_ASSERT( FIELD_OFFSET(struct add_fd_completion_request, status) == 32 );
+C_ASSERT( FIELD_OFFSET(struct add_fd_completion_request, event) == 36 );
 C_ASSERT( sizeof(struct add_fd_completion_request) == 40 );
 C_ASSERT( FIELD_OFFSET(struct set_fd_disp_info_request, handle) == 12 );
 C_ASSERT( FIELD_OFFSET(struct set_fd_disp_info_request, unlink) == 16 );
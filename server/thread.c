@@ -651,7 +651,7 @@ static int wait_on_handles( const select_op_t *select_op, unsigned int count, co
 }
 
 /* check if the thread waiting condition is satisfied */
-static int check_wait( struct thread *thread )
+static int check_wait_objects( struct thread *thread )
 {
     int i;
     struct thread_wait *wait = thread->wait;
@@ -696,6 +696,15 @@ static int check_wait( struct thread *thread )
     return -1;
 }
 
+static int check_wait( struct thread *thread )
+{
+    int ret = check_wait_objects( thread );
+
+    /* objects with state shared with the clients keep it locked until the check is done */
+    unlock_fast_sync();
+    return ret;
+}
+
 /* send the wakeup signal to a thread */
 static int send_thread_wakeup( struct thread *thread, client_ptr_t cookie, int signaled )
 {
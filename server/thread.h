@@ -64,7 +64,7 @@ struct thread
     struct inflight_fd     inflight[MAX_INFLIGHT_FDS];  /* fds currently in flight */
     unsigned int           error;         /* current error code */
     union generic_request  req;           /* current request */
-    void                  *req_data;      /* variable-size data for request */
+    void                  *req_data;      /* variable-size data for request (kept across small requests) */
     unsigned int           req_toread;    /* amount of data still to read in request */
     void                  *reply_data;    /* variable-size data for reply */
     unsigned int           reply_size;    /* size of reply data */
@@ -1203,6 +1203,25 @@ static void dump_varargs_handle_infos( const char *prefix, data_size_t size )
     fputc( '}', stderr );
 }
 
+static void dump_varargs_completion_infos( const char *prefix, data_size_t size )
+{
+    const struct completion_info *info;
+
+    fprintf( stderr, "%s{", prefix );
+    while (size >= sizeof(*info))
+    {
+        info = cur_data;
+        dump_uint64( "{ckey=", &info->ckey );
+        dump_uint64( ",cvalue=", &info->cvalue );
+        dump_uint64( ",information=", &info->information );
+        fprintf( stderr, ",status=%08x}", info->status );
+        size -= sizeof(*info);
+        remove_data( sizeof(*info) );
+        if (size) fputc( ',', stderr );
+    }
+    fputc( '}', stderr );
+}
+
 typedef void (*dump_func)( const void *req );
 
 /* Everything below this line is generated automatically by tools/make_requests */
@@ -1542,12 +1561,14 @@ static void dump_create_event_request( const struct create_event_request *req )
     fprintf( stderr, " access=%08x", req->access );
     fprintf( stderr, ", manual_reset=%d", req->manual_reset );
     fprintf( stderr, ", initial_state=%d", req->initial_state );
+    fprintf( stderr, ", fast_sync=%d", req->fast_sync );
     dump_varargs_object_attributes( ", objattr=", cur_size );
 }
 
 static void dump_create_event_reply( const struct create_event_reply *req )
 {
     fprintf( stderr, " handle=%04x", req->handle );
+    fprintf( stderr, ", fast_sync=%d", req->fast_sync );
 }
 
 static void dump_event_op_request( const struct event_op_request *req )
@@ -1656,12 +1677,14 @@ static void dump_create_semaphore_request( const struct create_semaphore_request
     fprintf( stderr, " access=%08x", req->access );
     fprintf( stderr, ", initial=%08x", req->initial );
     fprintf( stderr, ", max=%08x", req->max );
+    fprintf( stderr, ", fast_sync=%d", req->fast_sync );
     dump_varargs_object_attributes( ", objattr=", cur_size );
 }
 
 static void dump_create_semaphore_reply( const struct create_semaphore_reply *req )
 {
     fprintf( stderr, " handle=%04x", req->handle );
+    fprintf( stderr, ", fast_sync=%d", req->fast_sync );
 }
 
 static void dump_release_semaphore_request( const struct release_semaphore_request *req )
@@ -1699,6 +1722,20 @@ static void dump_open_semaphore_reply( const struct open_semaphore_reply *req )
     fprintf( stderr, " handle=%04x", req->handle );
 }
 
+static void dump_get_fast_sync_shm_request( const struct get_fast_sync_shm_request *req )
+{
+}
+
+static void dump_get_fast_sync_shm_reply( const struct get_fast_sync_shm_reply *req )
+{
+    fprintf( stderr, " handle=%04x", req->handle );
+}
+
+static void dump_fast_sync_wake_request( const struct fast_sync_wake_request *req )
+{
+    fprintf( stderr, " handle=%04x", req->handle );
+}
+
 static void dump_create_file_request( const struct create_file_request *req )
 {
     fprintf( stderr, " access=%08x", req->access );
@@ -2669,6 +2706,7 @@ static void dump_get_msg_queue_request( const struct get_msg_queue_request *req
 static void dump_get_msg_queue_reply( const struct get_msg_queue_reply *req )
 {
     fprintf( stderr, " handle=%04x", req->handle );
+    fprintf( stderr, ", shm_mapping=%04x", req->shm_mapping );
 }
 
 static void dump_set_queue_fd_request( const struct set_queue_fd_request *req )
@@ -3158,6 +3196,15 @@ static void dump_get_window_rectangles_reply( const struct get_window_rectangles
     dump_rectangle( ", client=", &req->client );
 }
 
+static void dump_get_window_shm_request( const struct get_window_shm_request *req )
+{
+}
+
+static void dump_get_window_shm_reply( const struct get_window_shm_reply *req )
+{
+    fprintf( stderr, " handle=%04x", req->handle );
+}
+
 static void dump_get_window_text_request( const struct get_window_text_request *req )
 {
     fprintf( stderr, " handle=%08x", req->handle );
@@ -3520,6 +3567,15 @@ static void dump_get_key_state_reply( const struct get_key_state_reply *req )
     dump_varargs_bytes( ", keystate=", cur_size );
 }
 
+static void dump_get_desktop_shm_request( const struct get_desktop_shm_request *req )
+{
+}
+
+static void dump_get_desktop_shm_reply( const struct get_desktop_shm_reply *req )
+{
+    fprintf( stderr, " handle=%04x", req->handle );
+}
+
 static void dump_set_key_state_request( const struct set_key_state_request *req )
 {
     fprintf( stderr, " tid=%04x", req->tid );
@@ -4289,6 +4345,16 @@ static void dump_remove_completion_reply( const struct remove_completion_reply *
     fprintf( stderr, ", status=%08x", req->status );
 }
 
+static void dump_remove_completions_request( const struct remove_completions_request *req )
+{
+    fprintf( stderr, " handle=%04x", req->handle );
+}
+
+static void dump_remove_completions_reply( const struct remove_completions_reply *req )
+{
+    dump_varargs_completion_infos( " packets=", cur_size );
+}
+
 static void dump_query_completion_request( const struct query_completion_request *req )
 {
     fprintf( stderr, " handle=%04x", req->handle );
@@ -4312,6 +4378,7 @@ static void dump_add_fd_completion_request( const struct add_fd_completion_reque
     dump_uint64( ", cvalue=", &req->cvalue );
     dump_uint64( ", information=", &req->information );
     fprintf( stderr, ", status=%08x", req->status );
+    fprintf( stderr, ", event=%04x", req->event );
 }
 
 static void dump_set_fd_disp_info_request( const struct set_fd_disp_info_request *req )
@@ -4500,6 +4567,8 @@ static const dump_func req_dumpers[REQ_NB_REQUESTS] = {
     (dump_func)dump_release_semaphore_request,
     (dump_func)dump_query_semaphore_request,
     (dump_func)dump_open_semaphore_request,
+    (dump_func)dump_get_fast_sync_shm_request,
+    (dump_func)dump_fast_sync_wake_request,
     (dump_func)dump_create_file_request,
     (dump_func)dump_open_file_object_request,
     (dump_func)dump_alloc_file_handle_request,
@@ -4625,6 +4694,7 @@ static const dump_func req_dumpers[REQ_NB_REQUESTS] = {
     (dump_func)dump_get_window_tree_request,
     (dump_func)dump_set_window_pos_request,
     (dump_func)dump_get_window_rectangles_request,
+    (dump_func)dump_get_window_shm_request,
     (dump_func)dump_get_window_text_request,
     (dump_func)dump_set_window_text_request,
     (dump_func)dump_get_windows_offset_request,
@@ -4659,6 +4729,7 @@ static const dump_func req_dumpers[REQ_NB_REQUESTS] = {
     (dump_func)dump_get_thread_input_request,
     (dump_func)dump_get_last_input_time_request,
     (dump_func)dump_get_key_state_request,
+    (dump_func)dump_get_desktop_shm_request,
     (dump_func)dump_set_key_state_request,
     (dump_func)dump_set_foreground_window_request,
     (dump_func)dump_set_focus_window_request,
@@ -4723,6 +4794,7 @@ static const dump_func req_dumpers[REQ_NB_REQUESTS] = {
     (dump_func)dump_open_completion_request,
     (dump_func)dump_add_completion_request,
     (dump_func)dump_remove_completion_request,
+    (dump_func)dump_remove_completions_request,
     (dump_func)dump_query_completion_request,
     (dump_func)dump_set_completion_info_request,
     (dump_func)dump_add_fd_completion_request,
@@ -4786,6 +4858,8 @@ static const dump_func reply_dumpers[REQ_NB_REQUESTS] = {
     (dump_func)dump_release_semaphore_reply,
     (dump_func)dump_query_semaphore_reply,
     (dump_func)dump_open_semaphore_reply,
+    (dump_func)dump_get_fast_sync_shm_reply,
+    NULL,
     (dump_func)dump_create_file_reply,
     (dump_func)dump_open_file_object_reply,
     (dump_func)dump_alloc_file_handle_reply,
@@ -4911,6 +4985,7 @@ static const dump_func reply_dumpers[REQ_NB_REQUESTS] = {
     (dump_func)dump_get_window_tree_reply,
     (dump_func)dump_set_window_pos_reply,
     (dump_func)dump_get_window_rectangles_reply,
+    (dump_func)dump_get_window_shm_reply,
     (dump_func)dump_get_window_text_reply,
     NULL,
     (dump_func)dump_get_windows_offset_reply,
@@ -4945,6 +5020,7 @@ static const dump_func reply_dumpers[REQ_NB_REQUESTS] = {
     (dump_func)dump_get_thread_input_reply,
     (dump_func)dump_get_last_input_time_reply,
     (dump_func)dump_get_key_state_reply,
+    (dump_func)dump_get_desktop_shm_reply,
     NULL,
     (dump_func)dump_set_foreground_window_reply,
     (dump_func)dump_set_focus_window_reply,
@@ -5009,6 +5085,7 @@ static const dump_func reply_dumpers[REQ_NB_REQUESTS] = {
     (dump_func)dump_open_completion_reply,
     NULL,
     (dump_func)dump_remove_completion_reply,
+    (dump_func)dump_remove_completions_reply,
     (dump_func)dump_query_completion_reply,
     NULL,
     NULL,
@@ -5072,6 +5149,8 @@ static const char * const req_names[REQ_NB_REQUESTS] = {
     "release_semaphore",
     "query_semaphore",
     "open_semaphore",
+    "get_fast_sync_shm",
+    "fast_sync_wake",
     "create_file",
     "open_file_object",
     "alloc_file_handle",
@@ -5197,6 +5276,7 @@ static const char * const req_names[REQ_NB_REQUESTS] = {
     "get_window_tree",
     "set_window_pos",
     "get_window_rectangles",
+    "get_window_shm",
     "get_window_text",
     "set_window_text",
     "get_windows_offset",
@@ -5231,6 +5311,7 @@ static const char * const req_names[REQ_NB_REQUESTS] = {
     "get_thread_input",
     "get_last_input_time",
     "get_key_state",
+    "get_desktop_shm",
     "set_key_state",
     "set_foreground_window",
     "set_focus_window",
@@ -5295,6 +5376,7 @@ static const char * const req_names[REQ_NB_REQUESTS] = {
     "open_completion",
     "add_completion",
     "remove_completion",
+    "remove_completions",
     "query_completion",
     "set_completion_info",
     "add_fd_completion",
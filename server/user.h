@@ -77,6 +77,8 @@ struct desktop
     unsigned int         users;            /* processes and threads using this desktop */
     struct global_cursor cursor;           /* global cursor information */
     unsigned char        keystate[256];    /* asynchronous key state */
+    struct object       *shm_mapping;      /* mapping of the input state shared with the clients */
+    volatile desktop_shm_t *shm;           /* input state shared with the clients */
 };
 
 /* user handles functions */
@@ -102,6 +104,8 @@ extern struct thread *get_first_global_hook( int id );
 
 /* queue functions */
 
+extern void free_desktop_shm( struct desktop *desktop );
+
 extern void free_msg_queue( struct thread *thread );
 extern struct hook_table *get_queue_hooks( struct thread *thread );
 extern void set_queue_hooks( struct thread *thread, struct hook_table *hooks );
@@ -33,6 +33,8 @@
 #include "winternl.h"
 
 #include "object.h"
+#include "file.h"
+#include "handle.h"
 #include "request.h"
 #include "thread.h"
 #include "process.h"
@@ -118,6 +120,11 @@ static struct window *shell_listview;
 static struct window *progman_window;
 static struct window *taskman_window;
 
+/* window information shared with the clients, indexed by user handle */
+#define NB_WINDOW_SHM_ENTRIES ((LAST_USER_HANDLE - FIRST_USER_HANDLE + 1) >> 1)
+static struct object *window_shm_mapping;
+static volatile window_shm_t *window_shm;
+
 /* magic HWND_TOP etc. pointers */
 #define WINPTR_TOP       ((struct window *)1L)
 #define WINPTR_BOTTOM    ((struct window *)2L)
@@ -174,6 +181,54 @@ static inline void update_pixel_format_flags( struct window *win )
         win->paint_flags |= PAINT_PIXEL_FORMAT_CHILD;
 }
 
+/* update the shared information of a window */
+static void update_window_shm( struct window *win )
+{
+    volatile window_shm_t *shm;
+
+    if (!window_shm) return;
+    shm = &window_shm[((win->handle & 0xffff) - FIRST_USER_HANDLE) >> 1];
+    shm->seq++;
+    __sync_synchronize();
+    shm->handle   = win->handle;
+    shm->parent   = win->parent ? win->parent->handle : 0;
+    shm->owner    = win->owner;
+    shm->style    = win->style;
+    shm->ex_style = win->ex_style;
+    shm->window   = win->window_rect;
+    shm->client   = win->client_rect;
+    __sync_synchronize();
+    shm->seq++;
+}
+
+/* mark the shared information of a window as free */
+static void free_window_shm( struct window *win )
+{
+    volatile window_shm_t *shm;
+
+    if (!window_shm) return;
+    shm = &window_shm[((win->handle & 0xffff) - FIRST_USER_HANDLE) >> 1];
+    shm->seq++;
+    __sync_synchronize();
+    shm->handle = 0;
+    __sync_synchronize();
+    shm->seq++;
+}
+
+/* create the mapping of the shared window information */
+static void create_window_shm(void)
+{
+    void *ptr;
+
+    if (!(window_shm_mapping = create_shared_mapping( NB_WINDOW_SHM_ENTRIES * sizeof(window_shm_t), &ptr )))
+    {
+        clear_error();  /* clients will fall back to server requests */
+        return;
+    }
+    make_object_static( window_shm_mapping );
+    window_shm = ptr;
+}
+
 /* link a window at the right place in the siblings list */
 static void link_window( struct window *win, struct window *previous )
 {
@@ -227,6 +282,7 @@ static void link_window( struct window *win, struct window *previous )
     }
 
     win->is_linked = 1;
+    update_window_shm( win );
 }
 
 /* change the parent of a window (or unlink the window if the new parent is NULL) */
@@ -263,6 +319,7 @@ static int set_parent_window( struct window *win, struct window *parent )
         list_add_head( &win->parent->unlinked, &win->entry );
         win->is_linked = 0;
     }
+    update_window_shm( win );
     return 1;
 }
 
@@ -466,6 +523,7 @@ static struct window *create_window( struct window *parent, struct window *owner
         goto failed;
     }
 
+    if (!window_shm_mapping) create_window_shm();
     if (!(win = mem_alloc( sizeof(*win) + extra_bytes - 1 ))) goto failed;
     if (!(win->handle = alloc_user_handle( win, USER_WINDOW ))) goto failed;
 
@@ -527,6 +585,7 @@ static struct window *create_window( struct window *parent, struct window *owner
     }
 
     current->desktop_users++;
+    update_window_shm( win );
     return win;
 
 failed:
@@ -1670,8 +1729,10 @@ static void set_window_pos( struct window *win, struct window *previous,
             offset_rect( &child->window_rect, new_size - old_size, 0 );
             offset_rect( &child->visible_rect, new_size - old_size, 0 );
             offset_rect( &child->client_rect, new_size - old_size, 0 );
+            update_window_shm( child );
         }
     }
+    update_window_shm( win );
 
     /* reset cursor clip rectangle when the desktop changes size */
     if (win == win->desktop->top_window) win->desktop->cursor.clip = *window_rect;
@@ -1856,6 +1917,7 @@ void destroy_window( struct window *win )
     if (win == taskman_window) taskman_window = NULL;
     free_hotkeys( win->desktop, win->handle );
     cleanup_clipboard_window( win->desktop, win->handle );
+    free_window_shm( win );
     free_user_handle( win->handle );
     destroy_properties( win );
     list_remove( &win->entry );
@@ -1967,6 +2029,7 @@ DECL_HANDLER(get_desktop_window)
         {
             detach_window_thread( desktop->top_window );
             desktop->top_window->style  = WS_POPUP | WS_VISIBLE | WS_CLIPSIBLINGS | WS_CLIPCHILDREN;
+            update_window_shm( desktop->top_window );
         }
     }
 
@@ -1979,6 +2042,7 @@ DECL_HANDLER(get_desktop_window)
         {
             detach_window_thread( desktop->msg_window );
             desktop->msg_window->style = WS_POPUP | WS_CLIPSIBLINGS | WS_CLIPCHILDREN;
+            update_window_shm( desktop->msg_window );
         }
     }
 
@@ -2014,6 +2078,7 @@ DECL_HANDLER(set_window_owner)
 
     reply->prev_owner = win->owner;
     reply->full_owner = win->owner = owner ? owner->handle : 0;
+    update_window_shm( win );
 }
 
 
@@ -2087,6 +2152,8 @@ DECL_HANDLER(set_window_info)
     if (req->flags & SET_WIN_EXTRA) memcpy( win->extra_bytes + req->extra_offset,
                                             &req->extra_value, req->extra_size );
 
+    if (req->flags & (SET_WIN_STYLE | SET_WIN_EXSTYLE)) update_window_shm( win );
+
     /* changing window style triggers a non-client paint */
     if (req->flags & SET_WIN_STYLE) win->paint_flags |= PAINT_NONCLIENT;
 }
@@ -2358,6 +2425,18 @@ DECL_HANDLER(get_window_rectangles)
 }
 
 
+/* get the mapping of the window information shared with the clients */
+DECL_HANDLER(get_window_shm)
+{
+    if (!window_shm_mapping)
+    {
+        set_error( STATUS_NOT_SUPPORTED );
+        return;
+    }
+    reply->handle = alloc_handle( current->process, window_shm_mapping, SECTION_MAP_READ, 0 );
+}
+
+
 /* get the window text */
 DECL_HANDLER(get_window_text)
 {